@@ -1 +1,673 @@
-#include "Task.hpp"
\ No newline at end of file
+#include "Task.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define FAI_X86_KERNELS
+// gcc AVX-512 intrinsics use self initialized undefined vectors, the warnings are only
+// silenced around them and the AVX-512 kernels
+#if defined(__GNUC__) && !defined(__clang__)
+#define FAI_GCC_AVX512_WARNINGS
+#endif
+#ifdef FAI_GCC_AVX512_WARNINGS
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#ifdef FAI_GCC_AVX512_WARNINGS
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+namespace
+{
+/**
+ * @brief scalar kernel, also used for the tails of the vectorized ones
+ */
+template <typename Int>
+fai::Cost evaluate_scalar(Task_columns<Int> columns,
+                          Scheduling const& solution,
+                          fai::Index        beg,
+                          Int               curr_time) noexcept
+{
+  Int f = 0;
+  for (fai::Index k = beg; k < solution.size(); ++k)
+  {
+    fai::Index i = solution[k];
+    f += columns.get_cost(i, curr_time);
+    curr_time += columns.exec_times[i];
+  }
+  return f;
+}
+
+/**
+ * @brief scalar batch kernel: the lanes candidates are independent dependency chains
+ *
+ * @param costs output for the lanes candidates
+ */
+template <typename Int, std::size_t lanes>
+void evaluate_batch_scalar(Task_columns<Int> columns,
+                           fai::Index        nb_tasks,
+                           Scheduling const* candidates,
+                           fai::Cost*        costs) noexcept
+{
+  fai::Index const* lane_candidates[lanes];
+  for (std::size_t l = 0; l < lanes; ++l)
+  {
+    lane_candidates[l] = candidates[l].data();
+  }
+
+  Int curr_times[lanes]{};
+  Int f[lanes]{};
+  for (fai::Index k = 0; k < nb_tasks; ++k)
+  {
+    for (std::size_t l = 0; l < lanes; ++l)
+    {
+      fai::Index i = lane_candidates[l][k];
+      f[l] += columns.get_cost(i, curr_times[l]);
+      curr_times[l] += columns.exec_times[i];
+    }
+  }
+  std::copy(std::begin(f), std::end(f), costs);
+}
+
+
+#ifdef FAI_X86_KERNELS
+
+/**
+ * @brief 64 bits lanes multiplication (there is no vpmullq before AVX-512DQ)
+ *
+ * wraps like the scalar multiplication:
+ *   a * b = lo(a)lo(b) + (hi(a)lo(b) + lo(a)hi(b)) << 32
+ */
+__attribute__((target("avx2"))) inline __m256i mul_epi64_avx2(__m256i a, __m256i b)
+{
+  __m256i lo = _mm256_mul_epu32(a, b);
+  __m256i a_hi_b = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b);
+  __m256i a_b_hi = _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32));
+  return _mm256_add_epi64(lo, _mm256_slli_epi64(_mm256_add_epi64(a_hi_b, a_b_hi), 32));
+}
+
+__attribute__((target("avx2"))) fai::Cost evaluate_avx2(
+  Task_columns<std::int64_t> columns,
+  Scheduling const&          solution) noexcept
+{
+  auto const* exec_times = reinterpret_cast<long long const*>(columns.exec_times);
+  auto const* expiry_starts = reinterpret_cast<long long const*>(columns.expiry_starts);
+  auto const* weights = reinterpret_cast<long long const*>(columns.weights);
+
+  __m256i const zero = _mm256_setzero_si256();
+  // all lanes hold the start time of the next 4 tasks
+  __m256i    curr_time = zero;
+  __m256i    f = zero;
+  fai::Index k = 0;
+  for (; k + 4 <= solution.size(); k += 4)
+  {
+    __m128i idx = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&solution[k]));
+    __m256i exec_time = _mm256_i32gather_epi64(exec_times, idx, 8);
+    __m256i expiry_start = _mm256_i32gather_epi64(expiry_starts, idx, 8);
+    __m256i weight = _mm256_i32gather_epi64(weights, idx, 8);
+
+    // inclusive prefix sum of the execution times: shift by 1 lane then by 2 lanes
+    __m256i end_time = _mm256_add_epi64(
+      exec_time,
+      _mm256_blend_epi32(_mm256_permute4x64_epi64(exec_time, 0x90), zero, 0x03));
+    end_time = _mm256_add_epi64(
+      end_time,
+      _mm256_blend_epi32(_mm256_permute4x64_epi64(end_time, 0x40), zero, 0x0F));
+
+    __m256i start_time =
+      _mm256_sub_epi64(_mm256_add_epi64(curr_time, end_time), exec_time);
+    curr_time = _mm256_add_epi64(curr_time, _mm256_permute4x64_epi64(end_time, 0xFF));
+
+    // branchless max(0, start_time - expiry_start)
+    __m256i delay = _mm256_sub_epi64(start_time, expiry_start);
+    delay = _mm256_and_si256(delay, _mm256_cmpgt_epi64(delay, zero));
+    f = _mm256_add_epi64(f, mul_epi64_avx2(delay, weight));
+  }
+
+  __m128i f_half =
+    _mm_add_epi64(_mm256_castsi256_si128(f), _mm256_extracti128_si256(f, 1));
+  fai::Cost f_sum = _mm_cvtsi128_si64(f_half) + _mm_extract_epi64(f_half, 1);
+  return f_sum + evaluate_scalar<std::int64_t>(
+                   columns,
+                   solution,
+                   k,
+                   _mm_cvtsi128_si64(_mm256_castsi256_si128(curr_time)));
+}
+
+/**
+ * @brief int32 version: 8 tasks per iteration
+ */
+__attribute__((target("avx2"))) fai::Cost evaluate_avx2(
+  Task_columns<std::int32_t> columns,
+  Scheduling const&          solution) noexcept
+{
+  __m256i const zero = _mm256_setzero_si256();
+  __m256i const last_lane = _mm256_set1_epi32(7);
+  // all lanes hold the start time of the next 8 tasks
+  __m256i    curr_time = zero;
+  __m256i    f = zero;
+  fai::Index k = 0;
+  for (; k + 8 <= solution.size(); k += 8)
+  {
+    __m256i idx = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&solution[k]));
+    __m256i exec_time = _mm256_i32gather_epi32(columns.exec_times, idx, 4);
+    __m256i expiry_start = _mm256_i32gather_epi32(columns.expiry_starts, idx, 4);
+    __m256i weight = _mm256_i32gather_epi32(columns.weights, idx, 4);
+
+    // inclusive prefix sum of the execution times: shift by 1 then 2 lanes in each 128
+    // bits half, then add the total of the low half to the high half
+    __m256i end_time = _mm256_add_epi32(exec_time, _mm256_slli_si256(exec_time, 4));
+    end_time = _mm256_add_epi32(end_time, _mm256_slli_si256(end_time, 8));
+    end_time = _mm256_add_epi32(
+      end_time,
+      _mm256_blend_epi32(zero,
+                         _mm256_permutevar8x32_epi32(end_time, _mm256_set1_epi32(3)),
+                         0xF0));
+
+    __m256i start_time =
+      _mm256_sub_epi32(_mm256_add_epi32(curr_time, end_time), exec_time);
+    curr_time =
+      _mm256_add_epi32(curr_time, _mm256_permutevar8x32_epi32(end_time, last_lane));
+
+    __m256i delay = _mm256_max_epi32(_mm256_sub_epi32(start_time, expiry_start), zero);
+    f = _mm256_add_epi32(f, _mm256_mullo_epi32(delay, weight));
+  }
+
+  __m128i f_sum =
+    _mm_add_epi32(_mm256_castsi256_si128(f), _mm256_extracti128_si256(f, 1));
+  f_sum = _mm_add_epi32(f_sum, _mm_shuffle_epi32(f_sum, 0x4E));
+  f_sum = _mm_add_epi32(f_sum, _mm_shuffle_epi32(f_sum, 0xB1));
+  return _mm_cvtsi128_si32(f_sum) +
+         evaluate_scalar<std::int32_t>(
+           columns,
+           solution,
+           k,
+           _mm_cvtsi128_si32(_mm256_castsi256_si128(curr_time)));
+}
+
+#ifdef FAI_GCC_AVX512_WARNINGS
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+__attribute__((target("avx512f,avx512dq"))) fai::Cost evaluate_avx512(
+  Task_columns<std::int64_t> columns,
+  Scheduling const&          solution) noexcept
+{
+  __m512i const zero = _mm512_setzero_si512();
+  // all lanes hold the start time of the next 8 tasks
+  __m512i    curr_time = zero;
+  __m512i    f = zero;
+  fai::Index k = 0;
+  for (; k + 8 <= solution.size(); k += 8)
+  {
+    __m256i idx = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&solution[k]));
+    __m512i exec_time = _mm512_i32gather_epi64(idx, columns.exec_times, 8);
+    __m512i expiry_start = _mm512_i32gather_epi64(idx, columns.expiry_starts, 8);
+    __m512i weight = _mm512_i32gather_epi64(idx, columns.weights, 8);
+
+    // inclusive prefix sum of the execution times: shift by 1, 2 then 4 lanes
+    __m512i end_time =
+      _mm512_add_epi64(exec_time, _mm512_alignr_epi64(exec_time, zero, 7));
+    end_time = _mm512_add_epi64(end_time, _mm512_alignr_epi64(end_time, zero, 6));
+    end_time = _mm512_add_epi64(end_time, _mm512_alignr_epi64(end_time, zero, 4));
+
+    __m512i start_time =
+      _mm512_sub_epi64(_mm512_add_epi64(curr_time, end_time), exec_time);
+    curr_time = _mm512_add_epi64(
+      curr_time,
+      _mm512_permutexvar_epi64(_mm512_set1_epi64(7), end_time));
+
+    __m512i delay = _mm512_max_epi64(_mm512_sub_epi64(start_time, expiry_start), zero);
+    f = _mm512_add_epi64(f, _mm512_mullo_epi64(delay, weight));
+  }
+
+  return _mm512_reduce_add_epi64(f) +
+         evaluate_scalar<std::int64_t>(
+           columns,
+           solution,
+           k,
+           _mm_cvtsi128_si64(_mm512_castsi512_si128(curr_time)));
+}
+
+/**
+ * @brief int32 version: 16 tasks per iteration
+ */
+__attribute__((target("avx512f,avx512dq"))) fai::Cost evaluate_avx512(
+  Task_columns<std::int32_t> columns,
+  Scheduling const&          solution) noexcept
+{
+  __m512i const zero = _mm512_setzero_si512();
+  // all lanes hold the start time of the next 16 tasks
+  __m512i    curr_time = zero;
+  __m512i    f = zero;
+  fai::Index k = 0;
+  for (; k + 16 <= solution.size(); k += 16)
+  {
+    __m512i idx = _mm512_loadu_si512(&solution[k]);
+    __m512i exec_time = _mm512_i32gather_epi32(idx, columns.exec_times, 4);
+    __m512i expiry_start = _mm512_i32gather_epi32(idx, columns.expiry_starts, 4);
+    __m512i weight = _mm512_i32gather_epi32(idx, columns.weights, 4);
+
+    // inclusive prefix sum of the execution times: shift by 1, 2, 4 then 8 lanes
+    __m512i end_time =
+      _mm512_add_epi32(exec_time, _mm512_alignr_epi32(exec_time, zero, 15));
+    end_time = _mm512_add_epi32(end_time, _mm512_alignr_epi32(end_time, zero, 14));
+    end_time = _mm512_add_epi32(end_time, _mm512_alignr_epi32(end_time, zero, 12));
+    end_time = _mm512_add_epi32(end_time, _mm512_alignr_epi32(end_time, zero, 8));
+
+    __m512i start_time =
+      _mm512_sub_epi32(_mm512_add_epi32(curr_time, end_time), exec_time);
+    curr_time = _mm512_add_epi32(
+      curr_time,
+      _mm512_permutexvar_epi32(_mm512_set1_epi32(15), end_time));
+
+    __m512i delay = _mm512_max_epi32(_mm512_sub_epi32(start_time, expiry_start), zero);
+    f = _mm512_add_epi32(f, _mm512_mullo_epi32(delay, weight));
+  }
+
+  return _mm512_reduce_add_epi32(f) +
+         evaluate_scalar<std::int32_t>(
+           columns,
+           solution,
+           k,
+           _mm_cvtsi128_si32(_mm512_castsi512_si128(curr_time)));
+}
+
+#ifdef FAI_GCC_AVX512_WARNINGS
+#pragma GCC diagnostic pop
+#endif
+
+/**
+ * @brief transpose 4 rows of 4 indices, rows[l][k] becomes rows[k][l]
+ */
+__attribute__((target("avx2"))) inline void transpose_epi32(__m128i (&rows)[4])
+{
+  __m128i t0 = _mm_unpacklo_epi32(rows[0], rows[1]);
+  __m128i t1 = _mm_unpackhi_epi32(rows[0], rows[1]);
+  __m128i t2 = _mm_unpacklo_epi32(rows[2], rows[3]);
+  __m128i t3 = _mm_unpackhi_epi32(rows[2], rows[3]);
+  rows[0] = _mm_unpacklo_epi64(t0, t2);
+  rows[1] = _mm_unpackhi_epi64(t0, t2);
+  rows[2] = _mm_unpacklo_epi64(t1, t3);
+  rows[3] = _mm_unpackhi_epi64(t1, t3);
+}
+
+/**
+ * @brief transpose 8 rows of 8 indices, rows[l][k] becomes rows[k][l]
+ */
+__attribute__((target("avx2"))) inline void transpose_epi32(__m256i (&rows)[8])
+{
+  __m256i t[8];
+  for (std::size_t r = 0; r < 8; r += 2)
+  {
+    t[r] = _mm256_unpacklo_epi32(rows[r], rows[r + 1]);
+    t[r + 1] = _mm256_unpackhi_epi32(rows[r], rows[r + 1]);
+  }
+  __m256i u[8];
+  for (std::size_t r = 0; r < 8; r += 4)
+  {
+    u[r] = _mm256_unpacklo_epi64(t[r], t[r + 2]);
+    u[r + 1] = _mm256_unpackhi_epi64(t[r], t[r + 2]);
+    u[r + 2] = _mm256_unpacklo_epi64(t[r + 1], t[r + 3]);
+    u[r + 3] = _mm256_unpackhi_epi64(t[r + 1], t[r + 3]);
+  }
+  for (std::size_t r = 0; r < 4; ++r)
+  {
+    rows[r] = _mm256_permute2x128_si256(u[r], u[r + 4], 0x20);
+    rows[r + 4] = _mm256_permute2x128_si256(u[r], u[r + 4], 0x31);
+  }
+}
+
+/**
+ * @brief the 8 candidates indices at position k
+ */
+__attribute__((target("avx2"))) inline __m256i load_position_epi32(
+  Scheduling const* candidates,
+  fai::Index        k)
+{
+  return _mm256_setr_epi32(candidates[0][k],
+                           candidates[1][k],
+                           candidates[2][k],
+                           candidates[3][k],
+                           candidates[4][k],
+                           candidates[5][k],
+                           candidates[6][k],
+                           candidates[7][k]);
+}
+
+/**
+ * @brief evaluate the task at the next position of each lane candidate
+ *
+ * @param idx task of each lane
+ * @param curr_time start time of each lane task, updated
+ * @param f cost of each lane, updated
+ */
+__attribute__((target("avx2"))) inline void batch_position_avx2(
+  Task_columns<std::int64_t> columns,
+  __m128i                    idx,
+  __m256i&                   curr_time,
+  __m256i&                   f)
+{
+  auto const* exec_times = reinterpret_cast<long long const*>(columns.exec_times);
+  auto const* expiry_starts = reinterpret_cast<long long const*>(columns.expiry_starts);
+  auto const* weights = reinterpret_cast<long long const*>(columns.weights);
+
+  __m256i exec_time = _mm256_i32gather_epi64(exec_times, idx, 8);
+  __m256i expiry_start = _mm256_i32gather_epi64(expiry_starts, idx, 8);
+  __m256i weight = _mm256_i32gather_epi64(weights, idx, 8);
+
+  __m256i delay = _mm256_sub_epi64(curr_time, expiry_start);
+  delay = _mm256_and_si256(delay, _mm256_cmpgt_epi64(delay, _mm256_setzero_si256()));
+  f = _mm256_add_epi64(f, mul_epi64_avx2(delay, weight));
+  curr_time = _mm256_add_epi64(curr_time, exec_time);
+}
+
+__attribute__((target("avx2"))) void evaluate_batch_avx2(
+  Task_columns<std::int64_t> columns,
+  fai::Index                 nb_tasks,
+  Scheduling const*          candidates,
+  fai::Cost*                 costs) noexcept
+{
+  __m256i const zero = _mm256_setzero_si256();
+  // lane l follows candidates[l]
+  __m256i curr_time = zero;
+  __m256i f = zero;
+
+  fai::Index k = 0;
+  for (; k + 4 <= nb_tasks; k += 4)
+  {
+    // 4 positions of the 4 candidates, transposed to get the indices of each position
+    __m128i idx[4];
+    for (std::size_t l = 0; l < 4; ++l)
+    {
+      idx[l] = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&candidates[l][k]));
+    }
+    transpose_epi32(idx);
+    for (__m128i const& pos_idx : idx)
+    {
+      batch_position_avx2(columns, pos_idx, curr_time, f);
+    }
+  }
+  for (; k < nb_tasks; ++k)
+  {
+    __m128i idx = _mm_setr_epi32(candidates[0][k],
+                                 candidates[1][k],
+                                 candidates[2][k],
+                                 candidates[3][k]);
+    batch_position_avx2(columns, idx, curr_time, f);
+  }
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(costs), f);
+}
+
+/**
+ * @brief int32 version of batch_position_avx2, for 8 candidates
+ */
+__attribute__((target("avx2"))) inline void batch_position_avx2(
+  Task_columns<std::int32_t> columns,
+  __m256i                    idx,
+  __m256i&                   curr_time,
+  __m256i&                   f)
+{
+  __m256i exec_time = _mm256_i32gather_epi32(columns.exec_times, idx, 4);
+  __m256i expiry_start = _mm256_i32gather_epi32(columns.expiry_starts, idx, 4);
+  __m256i weight = _mm256_i32gather_epi32(columns.weights, idx, 4);
+
+  __m256i delay =
+    _mm256_max_epi32(_mm256_sub_epi32(curr_time, expiry_start), _mm256_setzero_si256());
+  f = _mm256_add_epi32(f, _mm256_mullo_epi32(delay, weight));
+  curr_time = _mm256_add_epi32(curr_time, exec_time);
+}
+
+__attribute__((target("avx2"))) void evaluate_batch_avx2(
+  Task_columns<std::int32_t> columns,
+  fai::Index                 nb_tasks,
+  Scheduling const*          candidates,
+  fai::Cost*                 costs) noexcept
+{
+  __m256i const zero = _mm256_setzero_si256();
+  // lane l follows candidates[l]
+  __m256i curr_time = zero;
+  __m256i f = zero;
+
+  fai::Index k = 0;
+  for (; k + 8 <= nb_tasks; k += 8)
+  {
+    // 8 positions of the 8 candidates, transposed to get the indices of each position
+    __m256i idx[8];
+    for (std::size_t l = 0; l < 8; ++l)
+    {
+      idx[l] = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&candidates[l][k]));
+    }
+    transpose_epi32(idx);
+    for (__m256i const& pos_idx : idx)
+    {
+      batch_position_avx2(columns, pos_idx, curr_time, f);
+    }
+  }
+  for (; k < nb_tasks; ++k)
+  {
+    batch_position_avx2(columns, load_position_epi32(candidates, k), curr_time, f);
+  }
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(costs),
+                      _mm256_cvtepi32_epi64(_mm256_castsi256_si128(f)));
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(costs + 4),
+                      _mm256_cvtepi32_epi64(_mm256_extracti128_si256(f, 1)));
+}
+
+#ifdef FAI_GCC_AVX512_WARNINGS
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+/**
+ * @brief evaluate the task at the next position of each lane candidate
+ *
+ * @param idx task of each lane
+ * @param curr_time start time of each lane task, updated
+ * @param f cost of each lane, updated
+ */
+__attribute__((target("avx512f,avx512dq"))) inline void batch_position_avx512(
+  Task_columns<std::int64_t> columns,
+  __m256i                    idx,
+  __m512i&                   curr_time,
+  __m512i&                   f)
+{
+  __m512i exec_time = _mm512_i32gather_epi64(idx, columns.exec_times, 8);
+  __m512i expiry_start = _mm512_i32gather_epi64(idx, columns.expiry_starts, 8);
+  __m512i weight = _mm512_i32gather_epi64(idx, columns.weights, 8);
+
+  __m512i delay =
+    _mm512_max_epi64(_mm512_sub_epi64(curr_time, expiry_start), _mm512_setzero_si512());
+  f = _mm512_add_epi64(f, _mm512_mullo_epi64(delay, weight));
+  curr_time = _mm512_add_epi64(curr_time, exec_time);
+}
+
+__attribute__((target("avx512f,avx512dq"))) void evaluate_batch_avx512(
+  Task_columns<std::int64_t> columns,
+  fai::Index                 nb_tasks,
+  Scheduling const*          candidates,
+  fai::Cost*                 costs) noexcept
+{
+  __m512i const zero = _mm512_setzero_si512();
+  // lane l follows candidates[l]
+  __m512i curr_time = zero;
+  __m512i f = zero;
+
+  fai::Index k = 0;
+  for (; k + 8 <= nb_tasks; k += 8)
+  {
+    // 8 positions of the 8 candidates, transposed to get the indices of each position
+    __m256i idx[8];
+    for (std::size_t l = 0; l < 8; ++l)
+    {
+      idx[l] = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&candidates[l][k]));
+    }
+    transpose_epi32(idx);
+    for (__m256i const& pos_idx : idx)
+    {
+      batch_position_avx512(columns, pos_idx, curr_time, f);
+    }
+  }
+  for (; k < nb_tasks; ++k)
+  {
+    batch_position_avx512(columns, load_position_epi32(candidates, k), curr_time, f);
+  }
+  _mm512_storeu_si512(costs, f);
+}
+
+#ifdef FAI_GCC_AVX512_WARNINGS
+#pragma GCC diagnostic pop
+#endif
+
+#endif
+
+template <typename Int>
+fai::Cost evaluate_columns(Task_columns<Int> columns,
+                           Scheduling const& solution,
+                           Isa               isa) noexcept
+{
+  switch (isa)
+  {
+  case Isa::scalar:
+    return evaluate_scalar<Int>(columns, solution, 0, 0);
+  case Isa::avx2:
+#ifdef FAI_X86_KERNELS
+    return evaluate_avx2(columns, solution);
+#else
+    return evaluate_scalar<Int>(columns, solution, 0, 0);
+#endif
+  case Isa::avx512:
+#ifdef FAI_X86_KERNELS
+    return evaluate_avx512(columns, solution);
+#else
+    return evaluate_scalar<Int>(columns, solution, 0, 0);
+#endif
+  }
+  return evaluate_scalar<Int>(columns, solution, 0, 0);
+}
+
+template <typename Int>
+fai::vector<fai::Cost> evaluate_batch_columns(Task_columns<Int>              columns,
+                                              fai::Index                     nb_tasks,
+                                              std::vector<Scheduling> const& candidates,
+                                              Isa                            isa)
+{
+  fai::vector<fai::Cost> costs(fai::ssize(candidates));
+
+  // candidates per pass
+  fai::Index lanes = 8;
+  void (*evaluate_lanes)(Task_columns<Int>, fai::Index, Scheduling const*, fai::Cost*)
+    noexcept = evaluate_batch_scalar<Int, 8>;
+  switch (isa)
+  {
+  case Isa::scalar:
+    break;
+  case Isa::avx2:
+#ifdef FAI_X86_KERNELS
+    lanes = static_cast<fai::Index>(32 / sizeof(Int));
+    evaluate_lanes = evaluate_batch_avx2;
+#endif
+    break;
+  case Isa::avx512:
+#ifdef FAI_X86_KERNELS
+    if constexpr (std::is_same_v<Int, std::int64_t>)
+    {
+      evaluate_lanes = evaluate_batch_avx512;
+    }
+    else
+    {
+      // 8 int32 lanes: 16 would need a 16x16 transpose of the indices
+      evaluate_lanes = evaluate_batch_avx2;
+    }
+#endif
+    break;
+  }
+
+  fai::Index c = 0;
+  for (; c + lanes <= costs.size(); c += lanes)
+  {
+    evaluate_lanes(columns,
+                   nb_tasks,
+                   &candidates[static_cast<std::size_t>(c)],
+                   &costs[c]);
+  }
+  for (; c < costs.size(); ++c)
+  {
+    costs[c] = evaluate_columns(columns, candidates[static_cast<std::size_t>(c)], isa);
+  }
+  return costs;
+}
+} // namespace
+
+Isa get_host_isa() noexcept
+{
+#ifdef FAI_X86_KERNELS
+  static Isa const host_isa = []
+  {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq"))
+    {
+      return Isa::avx512;
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+      return Isa::avx2;
+    }
+    return Isa::scalar;
+  }();
+  return host_isa;
+#else
+  return Isa::scalar;
+#endif
+}
+
+Isa get_evaluate_isa() noexcept
+{
+  return get_host_isa() == Isa::avx512 ? Isa::avx512 : Isa::scalar;
+}
+
+std::string_view get_isa_name(Isa isa) noexcept
+{
+  switch (isa)
+  {
+  case Isa::scalar:
+    return "scalar";
+  case Isa::avx2:
+    return "avx2";
+  case Isa::avx512:
+    return "avx512";
+  }
+  return "unknown";
+}
+
+fai::Cost evaluate_unchecked(Task_table const& tasks,
+                             Scheduling const& solution,
+                             Isa               isa) noexcept
+{
+  if (tasks.is_narrow())
+  {
+    return evaluate_columns(tasks.get_columns<std::int32_t>(), solution, isa);
+  }
+  return evaluate_columns(tasks.get_columns<std::int64_t>(), solution, isa);
+}
+
+fai::vector<fai::Cost> evaluate_batch_unchecked(Task_table const&              tasks,
+                                                std::vector<Scheduling> const& candidates,
+                                                Isa                            isa)
+{
+  if (tasks.is_narrow())
+  {
+    return evaluate_batch_columns(tasks.get_columns<std::int32_t>(),
+                                  tasks.size(),
+                                  candidates,
+                                  isa);
+  }
+  return evaluate_batch_columns(tasks.get_columns<std::int64_t>(),
+                                tasks.size(),
+                                candidates,
+                                isa);
+}
@@ -8,8 +8,11 @@
 #include <cstdint>
 #include <istream>
 #include <iterator>
+#include <limits>
 #include <stdexcept>
-#include <unordered_set>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 namespace fai
 {
@@ -55,17 +58,61 @@ struct Task
 
 using Scheduling = fai::vector<fai::Index>;
 
-inline fai::Cost evaluate(fai::vector<Task> const& tasks, Scheduling const& solution)
+/**
+ * @brief a scheduling carrying its cost, so that it is evaluated once
+ */
+struct Scored_scheduling
+{
+  Scheduling solution;
+  fai::Cost  cost{};
+};
+
+/**
+ * @brief check that solution schedules each of the nb_tasks tasks exactly once
+ *
+ * to be used where solutions enter the program (files, constructed solutions), the search
+ * code only moves tasks around and uses evaluate_unchecked
+ *
+ * @throw std::invalid_argument if solution isn't a permutation of the tasks
+ */
+inline void check_scheduling(fai::Index nb_tasks, Scheduling const& solution)
 {
-  std::unordered_set<fai::Index> uniq_sol(std::begin(solution), std::end(solution));
-  if (tasks.size() != fai::ssize(uniq_sol))
+  if (nb_tasks != solution.size())
   {
-    throw std::invalid_argument(
-      fmt::format("Number of tasks {} != {} uniquely scheduled tasks",
-                  tasks.size(),
-                  uniq_sol.size()));
+    throw std::invalid_argument(fmt::format("Number of tasks {} != {} scheduled tasks",
+                                            nb_tasks,
+                                            solution.size()));
   }
 
+  std::vector<bool> scheduled(static_cast<std::size_t>(nb_tasks));
+  for (fai::Index i : solution)
+  {
+    if (i < 0 || i >= nb_tasks)
+    {
+      throw std::invalid_argument(
+        fmt::format("Scheduled task {} isn't in [0, {})", i, nb_tasks));
+    }
+    if (scheduled[static_cast<std::size_t>(i)])
+    {
+      throw std::invalid_argument(fmt::format("Task {} is scheduled twice", i));
+    }
+    scheduled[static_cast<std::size_t>(i)] = true;
+  }
+}
+
+/**
+ * @brief evaluate a solution known to be a valid scheduling of tasks
+ *
+ * hot path of the search: no check and no allocation, except on debug builds (NDEBUG not
+ * defined) where it falls back to check_scheduling
+ */
+inline fai::Cost evaluate_unchecked(fai::vector<Task> const& tasks,
+                                    Scheduling const&        solution)
+{
+#ifndef NDEBUG
+  check_scheduling(tasks.size(), solution);
+#endif
+
   fai::Sched_time f = 0;
   fai::Sched_time curr_time = 0;
 
@@ -76,4 +123,284 @@ inline fai::Cost evaluate(fai::vector<Task> const& tasks, Scheduling const& solu
   }
 
   return f;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief evaluate a solution, checking first it is a valid scheduling of tasks
+ *
+ * @throw std::invalid_argument if solution isn't a permutation of the tasks
+ */
+inline fai::Cost evaluate(fai::vector<Task> const& tasks, Scheduling const& solution)
+{
+  check_scheduling(tasks.size(), solution);
+  return evaluate_unchecked(tasks, solution);
+}
+
+/**
+ * @brief instruction sets of the evaluation kernels
+ */
+enum class Isa
+{
+  scalar,
+  avx2,
+  avx512,
+};
+
+/**
+ * @brief best instruction set supported by the host, detected once at runtime
+ */
+[[nodiscard]] Isa get_host_isa() noexcept;
+
+/**
+ * @brief instruction set of the single scheduling kernel: AVX-512 when the host has it,
+ * scalar otherwise as the AVX2 kernel is slower than the scalar one (its gathers wait on
+ * the prefix sum of the start times)
+ */
+[[nodiscard]] Isa get_evaluate_isa() noexcept;
+
+[[nodiscard]] std::string_view get_isa_name(Isa isa) noexcept;
+
+/**
+ * @brief raw columns of a Task_table, Int is the integer type of the arithmetic
+ */
+template <typename Int>
+struct Task_columns
+{
+  Int const* exec_times;
+  Int const* expiry_starts;
+  Int const* weights;
+
+  [[nodiscard]] Int get_cost(fai::Index i, Int start_time) const noexcept
+  {
+    return weights[i] * std::max(Int{0}, start_time - expiry_starts[i]);
+  }
+};
+
+/**
+ * @brief tasks of an instance, also stored as a structure of arrays for the evaluation
+ * kernels
+ *
+ * the cost of a task starting at t is weight * max(0, t - expiry_start), with
+ * expiry_start = expiry_time - exec_time precomputed
+ *
+ * when no scheduling of the instance can overflow 32 bits integers (is_narrow), the
+ * columns are also stored as int32: twice the SIMD lanes and half the memory traffic
+ */
+class Task_table
+{
+private:
+  fai::vector<Task>            tasks;
+  fai::vector<fai::Sched_time> exec_times;
+  fai::vector<fai::Sched_time> expiry_starts;
+  fai::vector<fai::Cost>       weights;
+  bool                         narrow{false};
+  // empty if !narrow
+  fai::vector<std::int32_t> exec_times32;
+  fai::vector<std::int32_t> expiry_starts32;
+  fai::vector<std::int32_t> weights32;
+
+public:
+  Task_table() = default;
+
+  explicit Task_table(fai::vector<Task> tasks_) : tasks(std::move(tasks_))
+  {
+    exec_times.reserve(tasks.size());
+    expiry_starts.reserve(tasks.size());
+    weights.reserve(tasks.size());
+    for (Task const& task : tasks)
+    {
+      exec_times.push_back(task.exec_time);
+      expiry_starts.push_back(task.expiry_time - task.exec_time);
+      weights.push_back(task.weight);
+    }
+
+    narrow = fits_int32();
+    if (narrow)
+    {
+      auto to_int32 = [](fai::vector<fai::Sched_time> const& column)
+      {
+        fai::vector<std::int32_t> column32(column.size());
+        std::transform(std::begin(column),
+                       std::end(column),
+                       std::begin(column32),
+                       [](fai::Sched_time value)
+                       { return static_cast<std::int32_t>(value); });
+        return column32;
+      };
+      exec_times32 = to_int32(exec_times);
+      expiry_starts32 = to_int32(expiry_starts);
+      weights32 = to_int32(weights);
+    }
+  }
+
+  [[nodiscard]] fai::vector<Task> const& get_tasks() const noexcept
+  {
+    return tasks;
+  }
+
+  [[nodiscard]] Task const& operator[](fai::Index i) const noexcept
+  {
+    return tasks[i];
+  }
+
+  [[nodiscard]] fai::Index size() const noexcept
+  {
+    return tasks.size();
+  }
+
+  [[nodiscard]] auto begin() const noexcept
+  {
+    return std::begin(tasks);
+  }
+
+  [[nodiscard]] auto end() const noexcept
+  {
+    return std::end(tasks);
+  }
+
+  [[nodiscard]] fai::Sched_time get_exec_time(fai::Index i) const noexcept
+  {
+    return exec_times[i];
+  }
+
+  [[nodiscard]] fai::Sched_time get_expiry_start(fai::Index i) const noexcept
+  {
+    return expiry_starts[i];
+  }
+
+  [[nodiscard]] fai::Cost get_weight(fai::Index i) const noexcept
+  {
+    return weights[i];
+  }
+
+  [[nodiscard]] fai::Cost get_cost(fai::Index      i,
+                                   fai::Sched_time start_time) const noexcept
+  {
+    return weights[i] * std::max(fai::Sched_time{0}, start_time - expiry_starts[i]);
+  }
+
+  /**
+   * @brief whether the start times, delays and costs of any scheduling fit in int32
+   */
+  [[nodiscard]] bool is_narrow() const noexcept
+  {
+    return narrow;
+  }
+
+  /**
+   * @brief int64 columns, or int32 ones which are only valid if is_narrow()
+   */
+  template <typename Int>
+  [[nodiscard]] Task_columns<Int> get_columns() const noexcept
+  {
+    static_assert(std::is_same_v<Int, std::int64_t> || std::is_same_v<Int, std::int32_t>);
+    if constexpr (std::is_same_v<Int, std::int32_t>)
+    {
+      return {exec_times32.data(), expiry_starts32.data(), weights32.data()};
+    }
+    else
+    {
+      return {exec_times.data(), expiry_starts.data(), weights.data()};
+    }
+  }
+
+private:
+  /**
+   * @brief overflow bounds of the instance
+   *
+   * a task starts at most at total_time - exec_time, so the cost of a scheduling is at
+   * most the sum of weight * max(0, total_time - expiry_time), and so are its partial
+   * sums as no term is negative
+   */
+  [[nodiscard]] bool fits_int32() const noexcept
+  {
+    constexpr fai::Sched_time max32 = std::numeric_limits<std::int32_t>::max();
+    constexpr fai::Sched_time min32 = std::numeric_limits<std::int32_t>::min();
+
+    fai::Sched_time total_time = 0;
+    for (fai::Sched_time exec_time : exec_times)
+    {
+      if (exec_time < 0)
+      {
+        return false;
+      }
+      total_time += exec_time;
+    }
+    if (total_time > max32)
+    {
+      return false;
+    }
+
+    fai::Cost max_cost = 0;
+    for (fai::Index i = 0; i < size(); ++i)
+    {
+      fai::Sched_time max_delay = total_time - exec_times[i] - expiry_starts[i];
+      if (weights[i] < 0 || expiry_starts[i] < min32 || max_delay > max32)
+      {
+        return false;
+      }
+      // at most 2^31 * 2^31, no int64 overflow
+      max_cost += weights[i] * std::max(fai::Sched_time{0}, max_delay);
+      if (max_cost > max32)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+/**
+ * @brief evaluate a valid scheduling with the kernel of the given instruction set
+ *
+ * every kernel gives the exact same result as the scalar evaluate, the int32 kernels are
+ * picked when the tasks are narrow
+ */
+[[nodiscard]] fai::Cost evaluate_unchecked(Task_table const& tasks,
+                                           Scheduling const& solution,
+                                           Isa               isa) noexcept;
+
+/**
+ * @brief evaluate a solution known to be a valid scheduling of tasks with the fastest
+ * kernel of the host, checks only on debug builds like the fai::vector<Task> overload
+ */
+inline fai::Cost evaluate_unchecked(Task_table const& tasks, Scheduling const& solution)
+{
+#ifndef NDEBUG
+  check_scheduling(tasks.size(), solution);
+#endif
+  return evaluate_unchecked(tasks, solution, get_evaluate_isa());
+}
+
+inline fai::Cost evaluate(Task_table const& tasks, Scheduling const& solution)
+{
+  check_scheduling(tasks.size(), solution);
+  return evaluate_unchecked(tasks, solution, get_evaluate_isa());
+}
+
+/**
+ * @brief evaluate many valid schedulings of tasks in one pass
+ *
+ * the candidates are interleaved: each SIMD lane (or independent dependency chain for
+ * the scalar kernel) follows one candidate, so the gathers of several candidates are in
+ * flight together instead of the prefix sum of a single one
+ *
+ * @return the cost of each candidate, in the same order
+ */
+[[nodiscard]] fai::vector<fai::Cost> evaluate_batch_unchecked(
+  Task_table const&              tasks,
+  std::vector<Scheduling> const& candidates,
+  Isa                            isa);
+
+inline fai::vector<fai::Cost> evaluate_batch_unchecked(
+  Task_table const&              tasks,
+  std::vector<Scheduling> const& candidates)
+{
+#ifndef NDEBUG
+  for (Scheduling const& candidate : candidates)
+  {
+    check_scheduling(tasks.size(), candidate);
+  }
+#endif
+  return evaluate_batch_unchecked(tasks, candidates, get_host_isa());
+}
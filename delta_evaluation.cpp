@@ -0,0 +1 @@
+#include "delta_evaluation.hpp"
\ No newline at end of file
@@ -0,0 +1,543 @@
+#pragma once
+
+#include "Task.hpp"
+#include "move.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief start times and cost prefixes of a base solution
+ *
+ * Used to compute the cost of a move only looking at the tasks it touches, instead of
+ * evaluating the whole neighbor.
+ */
+class Prefix_evaluation
+{
+private:
+  Task_table const* tasks;
+  Scheduling const* solution;
+  // start_times[k]: start time of the k-th scheduled task, start_times[n]: total time
+  fai::vector<fai::Sched_time> start_times;
+  // prefix_costs[k]: cost of the k first scheduled tasks
+  fai::vector<fai::Cost> prefix_costs;
+  // difference between the longest and the shortest execution time: the biggest shift a
+  // swap can apply to the tasks between the swapped ones
+  fai::Sched_time max_shift{0};
+  // late_weights[k]: weight of the k first scheduled tasks late by at least max_shift
+  fai::vector<fai::Cost> late_weights;
+  // positions of the tasks whose slack or lateness is less than max_shift
+  std::vector<fai::Index> critical_positions;
+
+public:
+  /**
+   * @brief solution must outlive the evaluation and not be modified meanwhile
+   */
+  Prefix_evaluation(Task_table const& tasks, Scheduling const& solution)
+    : tasks(&tasks),
+      solution(&solution),
+      start_times(solution.size() + 1),
+      prefix_costs(solution.size() + 1),
+      late_weights(solution.size() + 1)
+  {
+    fai::Sched_time min_exec_time = std::numeric_limits<fai::Sched_time>::max();
+    fai::Sched_time max_exec_time = 0;
+    for (fai::Index k = 0; k < solution.size(); ++k)
+    {
+      fai::Index i = solution[k];
+      prefix_costs[k + 1] = prefix_costs[k] + tasks.get_cost(i, start_times[k]);
+      start_times[k + 1] = start_times[k] + tasks.get_exec_time(i);
+      min_exec_time = std::min(min_exec_time, tasks.get_exec_time(i));
+      max_exec_time = std::max(max_exec_time, tasks.get_exec_time(i));
+    }
+    max_shift = std::max(max_exec_time - min_exec_time, fai::Sched_time{0});
+
+    for (fai::Index k = 0; k < solution.size(); ++k)
+    {
+      fai::Index      i = solution[k];
+      fai::Sched_time slack = tasks.get_expiry_start(i) - start_times[k];
+      late_weights[k + 1] = late_weights[k];
+      if (slack <= -max_shift)
+      {
+        late_weights[k + 1] += tasks.get_weight(i);
+      }
+      else if (slack < max_shift)
+      {
+        critical_positions.push_back(k);
+      }
+    }
+  }
+
+  [[nodiscard]] Task_table const& get_tasks() const noexcept
+  {
+    return *tasks;
+  }
+
+  [[nodiscard]] Scheduling const& get_base_solution() const noexcept
+  {
+    return *solution;
+  }
+
+  [[nodiscard]] fai::Cost get_cost() const noexcept
+  {
+    return prefix_costs[prefix_costs.size() - 1];
+  }
+
+  [[nodiscard]] fai::Sched_time get_start_time(fai::Index pos) const noexcept
+  {
+    return start_times[pos];
+  }
+
+  /**
+   * @brief cost of the base solution tasks scheduled in [beg, end)
+   */
+  [[nodiscard]] fai::Cost get_range_cost(fai::Index beg, fai::Index end) const noexcept
+  {
+    return prefix_costs[end] - prefix_costs[beg];
+  }
+
+  /**
+   * @brief cost of the tasks task_at(beg), ..., task_at(end - 1) scheduled in [beg, end)
+   *
+   * they must be a permutation of the base solution tasks in [beg, end), so that the
+   * range starts at the same time
+   */
+  template <typename Task_at>
+  [[nodiscard]] fai::Cost get_block_cost(fai::Index beg,
+                                         fai::Index end,
+                                         Task_at&&  task_at) const noexcept
+  {
+    if (tasks->is_narrow())
+    {
+      return get_block_cost(tasks->get_columns<std::int32_t>(), beg, end, task_at);
+    }
+    return get_block_cost(tasks->get_columns<std::int64_t>(), beg, end, task_at);
+  }
+
+  /**
+   * @brief cost of the base solution with its block [beg, end) reversed
+   */
+  [[nodiscard]] fai::Cost get_reversed_block_cost(fai::Index beg,
+                                                  fai::Index end) const noexcept
+  {
+    Scheduling const& sol = *solution;
+    return get_block_cost(beg, end, [&sol, beg, end](fai::Index k)
+                          { return sol[beg + end - 1 - k]; });
+  }
+
+  /**
+   * @brief cost of the base solution with its block [beg, end) rotated so that the task
+   * at middle becomes the first one
+   */
+  [[nodiscard]] fai::Cost get_rotated_block_cost(fai::Index beg,
+                                                 fai::Index middle,
+                                                 fai::Index end) const noexcept
+  {
+    Scheduling const& sol = *solution;
+    fai::Index        shift = middle - beg;
+    fai::Index        split = end - shift;
+    return get_block_cost(beg,
+                          end,
+                          [&sol, beg, shift, split](fai::Index k)
+                          { return k < split ? sol[k + shift] : sol[beg + k - split]; });
+  }
+
+  /**
+   * @brief cost of the base solution with the tasks at first and second swapped
+   *
+   * the tasks in between are shifted by the difference of the 2 execution times: the ones
+   * late by at least max_shift stay late and pay weight * shift, the ones with at least
+   * max_shift slack absorb the shift and stay in time, only the critical ones are
+   * evaluated: O(log(n) + critical tasks between first and second)
+   */
+  [[nodiscard]] fai::Cost get_swapped_cost(fai::Index first,
+                                           fai::Index second) const noexcept
+  {
+    Scheduling const& sol = *solution;
+    fai::Index        first_task = sol[first];
+    fai::Index        second_task = sol[second];
+    fai::Sched_time   shift =
+      tasks->get_exec_time(second_task) - tasks->get_exec_time(first_task);
+    fai::Cost cost = get_cost() - get_range_cost(first, first + 1) -
+                     get_range_cost(second, second + 1) +
+                     tasks->get_cost(second_task, start_times[first]) +
+                     tasks->get_cost(first_task, start_times[second] + shift);
+    if (shift == 0 || second - first < 2)
+    {
+      return cost;
+    }
+
+    cost += shift * (late_weights[second] - late_weights[first + 1]);
+    for (auto it = std::lower_bound(std::begin(critical_positions),
+                                    std::end(critical_positions),
+                                    first + 1);
+         it != std::end(critical_positions) && *it < second;
+         ++it)
+    {
+      cost += tasks->get_cost(sol[*it], start_times[*it] + shift) -
+              get_range_cost(*it, *it + 1);
+    }
+    return cost;
+  }
+
+  /**
+   * @brief cost of the neighbor described by move
+   *
+   * the tasks after the moved block keep their start time, so it costs O(end - beg)
+   */
+  [[nodiscard]] fai::Cost get_neighbor_cost(Move const& move) const noexcept
+  {
+    fai::Cost block_cost = 0;
+    switch (move.type)
+    {
+    case Move::Type::swap:
+      return get_swapped_cost(move.beg, move.end - 1);
+    case Move::Type::reverse:
+      block_cost = get_reversed_block_cost(move.beg, move.end);
+      break;
+    case Move::Type::rotate:
+      block_cost = get_rotated_block_cost(move.beg, move.middle, move.end);
+      break;
+    }
+    return get_cost() - get_range_cost(move.beg, move.end) + block_cost;
+  }
+
+private:
+  template <typename Int, typename Task_at>
+  [[nodiscard]] fai::Cost get_block_cost(Task_columns<Int> columns,
+                                         fai::Index        beg,
+                                         fai::Index        end,
+                                         Task_at&&         task_at) const noexcept
+  {
+    Int cost = 0;
+    // fits in Int as all the start times do
+    auto curr_time = static_cast<Int>(start_times[beg]);
+    for (fai::Index k = beg; k < end; ++k)
+    {
+      fai::Index i = task_at(k);
+      cost += columns.get_cost(i, curr_time);
+      curr_time += columns.exec_times[i];
+    }
+    return cost;
+  }
+};
+
+/**
+ * @brief cost of reversing a block [beg, end) of the base solution
+ *
+ * When the block grows by one at its end, the new task is scheduled first and delays
+ * all the others by its execution time, so the previous block cost is updated instead
+ * of recomputed: the late tasks cost weight * exec_time more, the in time tasks are kept
+ * in a min heap on the delay they can absorb before being late and only pay once popped.
+ *
+ * Growing costs O(log(end - beg)) amortized, other blocks are evaluated in O(end - beg).
+ */
+class Reversed_block_evaluation
+{
+private:
+  struct In_time_task
+  {
+    // total delay of the block from which the task is late
+    fai::Sched_time max_delay;
+    fai::Cost       weight;
+
+    friend bool operator>(In_time_task const& lhs, In_time_task const& rhs) noexcept
+    {
+      return lhs.max_delay > rhs.max_delay;
+    }
+  };
+
+  fai::Index beg{0};
+  fai::Index end{0};
+  // the heap state below is only valid for [beg, end) if is_incremental
+  bool            is_incremental{false};
+  fai::Sched_time delay{0};
+  fai::Cost       late_weight{0};
+  fai::Cost       block_cost{0};
+  // min heap on max_delay
+  std::vector<In_time_task> in_time_tasks;
+
+public:
+  /**
+   * @brief cost of the base solution with its block [beg, end) reversed
+   */
+  [[nodiscard]] fai::Cost get_neighbor_cost(Prefix_evaluation const& base_eval,
+                                            fai::Index               new_beg,
+                                            fai::Index               new_end)
+  {
+    if (new_beg != beg || new_end != end)
+    {
+      Scheduling const& base_sol = base_eval.get_base_solution();
+      if (new_beg == beg && new_end == end + 1)
+      {
+        if (!is_incremental)
+        {
+          // first growth from an evaluated block: build the heap state of [beg, end)
+          reset();
+          for (fai::Index k = beg; k < end; ++k)
+          {
+            push_front(base_eval, base_sol[k], beg);
+          }
+          is_incremental = true;
+        }
+        // the new task is the first of the reversed block
+        push_front(base_eval, base_sol[end], beg);
+      }
+      else
+      {
+        is_incremental = false;
+        block_cost = base_eval.get_reversed_block_cost(new_beg, new_end);
+      }
+      beg = new_beg;
+      end = new_end;
+    }
+    return base_eval.get_cost() - base_eval.get_range_cost(beg, end) + block_cost;
+  }
+
+private:
+  void reset() noexcept
+  {
+    delay = 0;
+    late_weight = 0;
+    block_cost = 0;
+    in_time_tasks.clear();
+  }
+
+  void push_front(Prefix_evaluation const& base_eval,
+                  fai::Index               task_idx,
+                  fai::Index               block_beg)
+  {
+    Task_table const& tasks = base_eval.get_tasks();
+    fai::Sched_time   exec_time = tasks.get_exec_time(task_idx);
+    fai::Cost         weight = tasks.get_weight(task_idx);
+
+    // delay all the tasks already in the block
+    delay += exec_time;
+    block_cost += late_weight * exec_time;
+    while (!in_time_tasks.empty() && in_time_tasks.front().max_delay < delay)
+    {
+      std::pop_heap(std::begin(in_time_tasks), std::end(in_time_tasks), std::greater<>{});
+      In_time_task const& late_task = in_time_tasks.back();
+      block_cost += late_task.weight * (delay - late_task.max_delay);
+      late_weight += late_task.weight;
+      in_time_tasks.pop_back();
+    }
+
+    fai::Sched_time sdelay =
+      base_eval.get_start_time(block_beg) - tasks.get_expiry_start(task_idx);
+    if (sdelay > 0)
+    {
+      block_cost += weight * sdelay;
+      late_weight += weight;
+    }
+    else
+    {
+      in_time_tasks.push_back({delay - sdelay, weight});
+      std::push_heap(std::begin(in_time_tasks),
+                     std::end(in_time_tasks),
+                     std::greater<>{});
+    }
+  }
+};
+
+/**
+ * @brief cost of moving the block of size len at from of the base solution so that it
+ * starts at position to
+ *
+ * The tasks between the block and to are shifted by the execution time of the block,
+ * earlier when it moves forward, later when it moves backward, and the block tasks keep
+ * their order. When to moves one step further from from, only the newly shifted task is
+ * evaluated with the block: O(len) instead of O(len + |to - from|).
+ */
+class Block_move_evaluation
+{
+private:
+  fai::Index from{-1};
+  fai::Index len{0};
+  fai::Index to{-1};
+  // sum of the cost changes of the shifted tasks
+  fai::Cost shifted_delta{0};
+
+public:
+  [[nodiscard]] fai::Cost get_neighbor_cost(Prefix_evaluation const& base_eval,
+                                            fai::Index               new_from,
+                                            fai::Index               new_len,
+                                            fai::Index               new_to)
+  {
+    if (new_from != from || new_len != len || (new_to > from) != (to > from) ||
+        std::abs(new_to - from) < std::abs(to - from))
+    {
+      from = new_from;
+      len = new_len;
+      to = new_from;
+      shifted_delta = 0;
+    }
+
+    Task_table const& tasks = base_eval.get_tasks();
+    Scheduling const& base_sol = base_eval.get_base_solution();
+    fai::Sched_time   block_time =
+      base_eval.get_start_time(from + len) - base_eval.get_start_time(from);
+    while (to < new_to)
+    {
+      // the task after the block is now before it
+      fai::Index      shifted = to + len;
+      fai::Sched_time shifted_start = base_eval.get_start_time(shifted) - block_time;
+      shifted_delta += tasks.get_cost(base_sol[shifted], shifted_start) -
+                       base_eval.get_range_cost(shifted, shifted + 1);
+      ++to;
+    }
+    while (to > new_to)
+    {
+      // the task before the block is now after it
+      --to;
+      fai::Sched_time shifted_start = base_eval.get_start_time(to) + block_time;
+      shifted_delta += tasks.get_cost(base_sol[to], shifted_start) -
+                       base_eval.get_range_cost(to, to + 1);
+    }
+
+    fai::Sched_time curr_time = to > from
+                                  ? base_eval.get_start_time(to + len) - block_time
+                                  : base_eval.get_start_time(to);
+    fai::Cost       block_cost = 0;
+    for (fai::Index k = from; k < from + len; ++k)
+    {
+      block_cost += tasks.get_cost(base_sol[k], curr_time);
+      curr_time += tasks.get_exec_time(base_sol[k]);
+    }
+    return base_eval.get_cost() - base_eval.get_range_cost(from, from + len) +
+           shifted_delta + block_cost;
+  }
+};
+
+/**
+ * @brief a solution with the start time and the cost of each of its tasks, modified in
+ * place
+ *
+ * A move only changes the start times of its block [beg, end): it is evaluated and
+ * applied in O(end - beg) whatever the number of tasks, where a Prefix_evaluation has to
+ * be built again in O(n) after each move. Made for the searches applying many small
+ * moves.
+ */
+class Incremental_evaluation
+{
+private:
+  Task_table const* tasks;
+  Scheduling        solution;
+  // start_times[k]: start time of the k-th scheduled task, start_times[n]: total time
+  fai::vector<fai::Sched_time> start_times;
+  // task_costs[k]: cost of the k-th scheduled task
+  fai::vector<fai::Cost> task_costs;
+  fai::Cost              cost{0};
+
+  /**
+   * @brief cost of the tasks task_at(beg), ..., task_at(end - 1) scheduled in [beg, end)
+   */
+  template <typename Task_at>
+  [[nodiscard]] fai::Cost get_block_cost(fai::Index beg,
+                                         fai::Index end,
+                                         Task_at&&  task_at) const noexcept
+  {
+    fai::Cost       block_cost = 0;
+    fai::Sched_time curr_time = start_times[beg];
+    for (fai::Index k = beg; k < end; ++k)
+    {
+      fai::Index i = task_at(k);
+      block_cost += tasks->get_cost(i, curr_time);
+      curr_time += tasks->get_exec_time(i);
+    }
+    return block_cost;
+  }
+
+public:
+  Incremental_evaluation(Task_table const& tasks, Scheduling solution)
+    : tasks(&tasks),
+      solution(std::move(solution)),
+      start_times(this->solution.size() + 1),
+      task_costs(this->solution.size())
+  {
+    for (fai::Index k = 0; k < this->solution.size(); ++k)
+    {
+      fai::Index i = this->solution[k];
+      task_costs[k] = tasks.get_cost(i, start_times[k]);
+      start_times[k + 1] = start_times[k] + tasks.get_exec_time(i);
+      cost += task_costs[k];
+    }
+  }
+
+  [[nodiscard]] Scheduling const& get_solution() const noexcept
+  {
+    return solution;
+  }
+
+  [[nodiscard]] fai::Cost get_cost() const noexcept
+  {
+    return cost;
+  }
+
+  /**
+   * @brief cost of the neighbor described by move: O(end - beg)
+   */
+  [[nodiscard]] fai::Cost get_neighbor_cost(Move const& move) const noexcept
+  {
+    Scheduling const& sol = solution;
+    fai::Index        beg = move.beg;
+    fai::Index        end = move.end;
+    fai::Cost         old_block_cost = 0;
+    for (fai::Index k = beg; k < end; ++k)
+    {
+      old_block_cost += task_costs[k];
+    }
+
+    fai::Cost new_block_cost = 0;
+    switch (move.type)
+    {
+    case Move::Type::swap:
+      new_block_cost = get_block_cost(beg,
+                                      end,
+                                      [&sol, beg, end](fai::Index k)
+                                      {
+                                        return k == beg       ? sol[end - 1]
+                                               : k == end - 1 ? sol[beg]
+                                                              : sol[k];
+                                      });
+      break;
+    case Move::Type::reverse:
+      new_block_cost = get_block_cost(beg, end, [&sol, beg, end](fai::Index k)
+                                      { return sol[beg + end - 1 - k]; });
+      break;
+    case Move::Type::rotate:
+    {
+      fai::Index shift = move.middle - beg;
+      fai::Index split = end - shift;
+      new_block_cost =
+        get_block_cost(beg,
+                       end,
+                       [&sol, beg, shift, split](fai::Index k)
+                       { return k < split ? sol[k + shift] : sol[beg + k - split]; });
+      break;
+    }
+    }
+    return cost - old_block_cost + new_block_cost;
+  }
+
+  /**
+   * @brief commit move, neighbor_cost is its get_neighbor_cost: O(end - beg)
+   */
+  void apply(Move const& move, fai::Cost neighbor_cost)
+  {
+    apply_move(solution, move);
+    for (fai::Index k = move.beg; k < move.end; ++k)
+    {
+      fai::Index i = solution[k];
+      task_costs[k] = tasks->get_cost(i, start_times[k]);
+      start_times[k + 1] = start_times[k] + tasks->get_exec_time(i);
+    }
+    cost = neighbor_cost;
+  }
+};
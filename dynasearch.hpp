@@ -0,0 +1,226 @@
+#pragma once
+
+#include "Task.hpp"
+#include "delta_evaluation.hpp"
+#include "local_search.hpp"
+#include "move.hpp"
+#include "precedence.hpp"
+#include "utils.hpp"
+
+#include <fmt/core.h>
+
+#include <optional>
+#include <vector>
+
+/**
+ * @brief selects the best set of disjoint swaps and insertions of a solution
+ *
+ * Dynasearch (Congram, Potts and van de Velde): a swap or an insertion only permutes the
+ * tasks of its block [i, j], the block starts and ends at the same times, so the moves of
+ * disjoint blocks don't change each other gains. The dynamic program over the positions
+ *   best_gains[j + 1] = max(best_gains[j], best_gains[i] + gain of a move of [i, j])
+ * gives the set of disjoint moves with the biggest total gain.
+ *
+ * one pass evaluates each of the O(n^2) swaps and insertions once: the insertions of the
+ * task at j before i are evaluated when i moves one step back, the ones of the task at i
+ * after j when j moves one step further, both in O(1), the swaps with
+ * Prefix_evaluation::get_swapped_cost
+ */
+class Dynasearch_selection
+{
+private:
+  // best_gains[k]: biggest total gain of disjoint moves in the positions [0, k)
+  fai::vector<fai::Cost> best_gains;
+  // last_moves[k]: last move of the set giving best_gains[k], none if the task at k - 1
+  // isn't moved
+  fai::vector<std::optional<Move>> last_moves;
+
+  long nb_neigh{0};
+  long nb_pruned{0};
+
+public:
+  /**
+   * @brief the disjoint moves of the base solution with the biggest total gain, from the
+   * last to the first one
+   *
+   * the adjacent swaps breaking a proven order of filter aren't selected, they never
+   * improve the solution
+   *
+   * @return the total gain, 0 if no move improves the base solution
+   */
+  fai::Cost select(Prefix_evaluation const& base_eval,
+                   Precedence_filter const* filter,
+                   std::vector<Move>&       moves)
+  {
+    Task_table const& tasks = base_eval.get_tasks();
+    Scheduling const& base_sol = base_eval.get_base_solution();
+    fai::Index        nb_tasks = base_sol.size();
+    fai::Cost         base_cost = base_eval.get_cost();
+
+    best_gains.assign(static_cast<std::size_t>(nb_tasks + 1), 0);
+    last_moves.assign(static_cast<std::size_t>(nb_tasks + 1), std::nullopt);
+    nb_neigh = 0;
+    nb_pruned = 0;
+
+    // move of the block [beg, end) with gain
+    auto consider = [&](Move const& move, fai::Cost gain)
+    {
+      if (filter != nullptr && filter->breaks(move))
+      {
+        ++nb_pruned;
+        return;
+      }
+      ++nb_neigh;
+      if (best_gains[move.beg] + gain > best_gains[move.end])
+      {
+        best_gains[move.end] = best_gains[move.beg] + gain;
+        last_moves[move.end] = move;
+      }
+    };
+
+    for (fai::Index k = 0; k < nb_tasks; ++k)
+    {
+      // best_gains[k] has all its candidates: the blocks ending before k
+      if (k > 0 && best_gains[k - 1] >= best_gains[k])
+      {
+        best_gains[k] = best_gains[k - 1];
+        last_moves[k] = std::nullopt;
+      }
+
+      // blocks [i, k]: the task at k swapped with or inserted before the one at i, the
+      // insertion shifts the tasks in [i, k) later by its execution time
+      fai::Index      last_task = base_sol[k];
+      fai::Sched_time last_exec_time = tasks.get_exec_time(last_task);
+      fai::Cost       shifted_delta = 0;
+      for (fai::Index i = k - 1; i >= 0; --i)
+      {
+        fai::Sched_time start_time = base_eval.get_start_time(i);
+        shifted_delta += tasks.get_cost(base_sol[i], start_time + last_exec_time) -
+                         base_eval.get_range_cost(i, i + 1);
+        consider(Move::swap(i, k), base_cost - base_eval.get_swapped_cost(i, k));
+        if (k - i >= 2)
+        {
+          consider(Move::insertion(k, i),
+                   base_eval.get_range_cost(k, k + 1) - shifted_delta -
+                     tasks.get_cost(last_task, start_time));
+        }
+      }
+
+      // blocks [k, j]: the task at k inserted after the one at j, the tasks in (k, j] are
+      // shifted earlier by its execution time
+      fai::Index      first_task = base_sol[k];
+      fai::Sched_time first_exec_time = tasks.get_exec_time(first_task);
+      shifted_delta = 0;
+      for (fai::Index j = k + 1; j < nb_tasks; ++j)
+      {
+        shifted_delta +=
+          tasks.get_cost(base_sol[j], base_eval.get_start_time(j) - first_exec_time) -
+          base_eval.get_range_cost(j, j + 1);
+        if (j - k >= 2)
+        {
+          consider(Move::insertion(k, j),
+                   base_eval.get_range_cost(k, k + 1) - shifted_delta -
+                     tasks.get_cost(first_task,
+                                    base_eval.get_start_time(j + 1) - first_exec_time));
+        }
+      }
+    }
+    if (nb_tasks > 0 && best_gains[nb_tasks - 1] >= best_gains[nb_tasks])
+    {
+      best_gains[nb_tasks] = best_gains[nb_tasks - 1];
+      last_moves[nb_tasks] = std::nullopt;
+    }
+
+    moves.clear();
+    for (fai::Index k = nb_tasks; k > 0;)
+    {
+      if (std::optional<Move> const& move = last_moves[k])
+      {
+        moves.push_back(*move);
+        k = move->beg;
+      }
+      else
+      {
+        --k;
+      }
+    }
+    return best_gains[nb_tasks];
+  }
+
+  /**
+   * @brief moves evaluated by the last selection
+   */
+  [[nodiscard]] long get_nb_neigh() const noexcept
+  {
+    return nb_neigh;
+  }
+
+  /**
+   * @brief moves skipped by the last selection as they break a precedence
+   */
+  [[nodiscard]] long get_nb_pruned() const noexcept
+  {
+    return nb_pruned;
+  }
+};
+
+/**
+ * @brief applies the best set of disjoint swaps and insertions until none improves the
+ * solution
+ *
+ * each iteration costs a scan of the swaps and insertions neighborhoods but can apply
+ * many moves, it takes far fewer iterations than hill_climbing to reach a local optimum
+ * of both neighborhoods
+ */
+inline Scored_scheduling dynasearch(Task_table const&     tasks,
+                                    Scored_scheduling     base_solution,
+                                    Search_options const& options = {})
+{
+  if (options.counters != nullptr)
+  {
+    options.counters->update_best(base_solution.cost);
+  }
+  Dynasearch_selection selection;
+  std::vector<Move>    moves;
+  while (true)
+  {
+    fai::Cost gain = 0;
+    {
+      Prefix_evaluation                base_eval(tasks, base_solution.solution);
+      std::optional<Precedence_filter> filter;
+      if (options.precedences != nullptr)
+      {
+        filter.emplace(*options.precedences, base_solution.solution);
+      }
+      gain = selection.select(base_eval, filter ? &*filter : nullptr, moves);
+    }
+    if (options.counters != nullptr)
+    {
+      options.counters->add_scan(selection.get_nb_neigh(), selection.get_nb_pruned());
+    }
+
+    if (gain <= 0)
+    {
+      // no more better neighbors
+      return base_solution;
+    }
+
+    // the blocks are disjoint, the moves can be applied in any order
+    for (Move const& move : moves)
+    {
+      apply_move(base_solution.solution, move);
+    }
+    base_solution.cost -= gain;
+    if (options.counters != nullptr)
+    {
+      options.counters->add_improvement(base_solution.cost);
+    }
+    if (fai::stop_request())
+    {
+      fmt::print("\nStopped at {} with:\n  {}\n",
+                 base_solution.cost,
+                 base_solution.solution);
+      return base_solution;
+    }
+  }
+}
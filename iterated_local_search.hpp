@@ -1,108 +1,478 @@
 #include "Task.hpp"
 #include "local_search.hpp"
 #include "neighborhood.hpp"
+#include "random.hpp"
 #include "utils.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
 #include <iterator>
-#include <random>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief what an ILS remembers of the solutions it met, in bounded memory
+ *
+ * - the costs of the last nb_recent solutions, in a ring buffer
+ * - the best solution and the iteration it was first met
+ * - optionally the nb_elites best solutions of distinct costs
+ *
+ * a solution is only copied when it is a new best one or enters the elite set, the stop
+ * and accept functions read the history in O(1)
+ */
+class Ils_history
+{
+private:
+  // recent_costs[iteration % recent_costs.size()]: cost of the solution of iteration
+  std::vector<fai::Cost> recent_costs;
+  std::size_t            nb_elites;
+  // sorted by increasing costs
+  std::vector<Scored_scheduling> elites;
+  Scored_scheduling              best_solution;
+  long                           best_iteration{-1};
+  long                           nb_iterations{0};
+
+  void add_elite(Scored_scheduling const& solution)
+  {
+    if (elites.size() == nb_elites && solution.cost >= elites.back().cost)
+    {
+      return;
+    }
+    auto it = std::lower_bound(std::begin(elites),
+                               std::end(elites),
+                               solution.cost,
+                               [](Scored_scheduling const& elite, fai::Cost cost)
+                               { return elite.cost < cost; });
+    if (it != std::end(elites) && it->cost == solution.cost)
+    {
+      return;
+    }
+    if (elites.size() == nb_elites)
+    {
+      elites.pop_back();
+    }
+    elites.insert(it, solution);
+  }
+
+public:
+  explicit Ils_history(std::size_t nb_recent = 64, std::size_t nb_elites = 0)
+    : recent_costs(std::max(nb_recent, std::size_t{1})), nb_elites(nb_elites)
+  {
+    elites.reserve(nb_elites);
+  }
+
+  /**
+   * @brief records the solution of a new iteration
+   */
+  void push(Scored_scheduling const& solution)
+  {
+    recent_costs[static_cast<std::size_t>(nb_iterations) % recent_costs.size()] =
+      solution.cost;
+    if (best_iteration < 0 || solution.cost < best_solution.cost)
+    {
+      best_solution = solution;
+      best_iteration = nb_iterations;
+    }
+    if (nb_elites > 0)
+    {
+      add_elite(solution);
+    }
+    ++nb_iterations;
+  }
+
+  [[nodiscard]] long size() const noexcept
+  {
+    return nb_iterations;
+  }
+
+  /**
+   * @brief cost of the solution pushed age iterations ago, 0 for the last one
+   *
+   * age must be lower than size() and than the number of recent costs kept
+   */
+  [[nodiscard]] fai::Cost get_recent_cost(long age) const noexcept
+  {
+    return recent_costs[static_cast<std::size_t>(nb_iterations - 1 - age) %
+                        recent_costs.size()];
+  }
+
+  [[nodiscard]] long get_nb_recent() const noexcept
+  {
+    return std::min(nb_iterations, static_cast<long>(recent_costs.size()));
+  }
+
+  /**
+   * @brief the best solution pushed, the oldest one on equal costs
+   */
+  [[nodiscard]] Scored_scheduling const& get_best() const noexcept
+  {
+    return best_solution;
+  }
+
+  /**
+   * @brief moves the best solution out of the history
+   */
+  Scored_scheduling take_best() noexcept
+  {
+    return std::move(best_solution);
+  }
+
+  /**
+   * @brief iterations pushed since the best solution was first met
+   */
+  [[nodiscard]] long get_nb_since_best() const noexcept
+  {
+    return nb_iterations - 1 - best_iteration;
+  }
+
+  /**
+   * @brief the best solutions of distinct costs, by increasing costs
+   */
+  [[nodiscard]] std::vector<Scored_scheduling> const& get_elites() const noexcept
+  {
+    return elites;
+  }
+};
+
+/**
+ * @brief uniformly drawn move of Neighborhood for a solution of nb_tasks tasks: O(1)
+ */
+template <class Neighborhood>
+Move random_move(fai::Index nb_tasks, fai::Xoshiro256pp& gen)
+{
+  return Neighborhood::get_move(nb_tasks, gen.below(Neighborhood::get_size(nb_tasks)));
+}
+
+/**
+ * @brief random_move drawn by the generator of the calling thread
+ */
+template <class Neighborhood>
+Move random_move(fai::Index nb_tasks)
+{
+  return random_move<Neighborhood>(nb_tasks, fai::thread_random_generator());
+}
 
 // disturb function
 template <class Neighborhood>
-Scheduling random_neighbor(Scheduling const& base_solution)
+void random_neighbor(Scheduling& solution)
 {
-  static std::mt19937             gen(std::random_device{}());
-  Neighborhood                    neighborhood(base_solution);
-  std::uniform_int_distribution<> distrib(0, neighborhood.size() - 1);
-  return neighborhood.at(distrib(gen));
+  apply_move(solution, random_move<Neighborhood>(solution.size()));
 };
 
 // disturb function
+/**
+ * @brief applies distance random moves of Neighborhood in place, without allocation:
+ * O(distance * block size)
+ */
 template <class Neighborhood>
-Scheduling random_distant_neighbor(Scheduling               solution,
-                                   fai::Index               distance,
-                                   std::vector<Scheduling>& history)
+void random_distant_neighbor(Scheduling&        solution,
+                             fai::Index         distance,
+                             Ils_history const& history)
 {
+  fai::Xoshiro256pp& gen = fai::thread_random_generator();
   for (fai::Index i = 0; i < distance; ++i)
   {
-    solution = random_neighbor<Neighborhood>(solution);
+    apply_move(solution, random_move<Neighborhood>(solution.size(), gen));
   }
-  return solution;
 }
 
 // disturb function
+/**
+ * @brief random_distant_neighbor with a number of moves adapted to the search
+ *
+ * - each perturbation without a new best solution multiplies the distance by growth, up
+ *   to max_distance, to leave the basin of the accepted solution
+ * - a new best solution resets it to the distance with the biggest best cost decrease per
+ *   CPU second, a moving average over the iterations run at each distance
+ *
+ * the time of an iteration is the CPU time of the thread between 2 perturbations, the
+ * local search included: the islands sharing a core aren't charged for each other
+ */
 template <class Neighborhood>
-class Random_dyn_dist_neighbor
+class Adaptive_perturbation
 {
-  double     aug;
-  double     step;
-  fai::Index max_step;
+private:
+  using Clock = fai::Thread_cpu_clock;
+
+  fai::Index min_distance;
+  fai::Index max_distance;
+  double     growth;
+  double     distance;
+  // gain_rates[d]: best cost decrease per CPU second of the iterations perturbed by d
+  // moves
+  std::vector<double> gain_rates;
+  // distance of the previous perturbation, 0 before the first one
+  fai::Index        last_distance{0};
+  fai::Cost         last_best_cost{0};
+  Clock::time_point last_time;
+
+  static constexpr double rate_weight = 0.3;
+
+  [[nodiscard]] fai::Index get_best_rate_distance() const noexcept
+  {
+    auto first = std::begin(gain_rates) + min_distance;
+    return min_distance +
+           static_cast<fai::Index>(
+             std::distance(first, std::max_element(first, std::end(gain_rates))));
+  }
 
 public:
-  Random_dyn_dist_neighbor(double     aug = 1.05,
-                           fai::Index step = 10,
-                           fai::Index max_step = 100)
-    : aug(aug), step(step)
+  explicit Adaptive_perturbation(fai::Index min_distance = 10,
+                                 fai::Index max_distance = 100,
+                                 double     growth = 1.1)
+    : min_distance(std::max(min_distance, fai::Index{1})),
+      max_distance(std::max(max_distance, this->min_distance)),
+      growth(growth),
+      distance(static_cast<double>(this->min_distance)),
+      gain_rates(static_cast<std::size_t>(this->max_distance) + 1, 0.)
   {
   }
 
-  Scheduling operator()(Scheduling solution) noexcept
+  void operator()(Scheduling& solution, Ils_history const& history)
   {
-    solution =
-      random_distant_neighbor<Neighborhood>(solution, static_cast<fai::Index>(step));
-    if (step < max_step)
+    Clock::time_point now = Clock::now();
+    fai::Cost         best_cost = history.get_best().cost;
+    if (last_distance > 0)
     {
-      step *= aug;
+      std::chrono::duration<double> iteration_time = now - last_time;
+      double gain_rate = static_cast<double>(last_best_cost - best_cost) /
+                         std::max(iteration_time.count(), 1e-9);
+      double& average = gain_rates[static_cast<std::size_t>(last_distance)];
+      average += rate_weight * (gain_rate - average);
+      distance = best_cost < last_best_cost
+                   ? static_cast<double>(get_best_rate_distance())
+                   : std::min(distance * growth, static_cast<double>(max_distance));
     }
-    return solution;
+    last_distance = static_cast<fai::Index>(distance);
+    last_best_cost = best_cost;
+    last_time = now;
+    random_distant_neighbor<Neighborhood>(solution, last_distance, history);
+  }
+
+  /**
+   * @brief number of moves of the next perturbation when it doesn't follow a new best
+   * solution
+   */
+  [[nodiscard]] fai::Index get_distance() const noexcept
+  {
+    return static_cast<fai::Index>(distance);
   }
 };
 
 // accept function
-inline void accept_best(fai::vector<Task> const& tasks,
-                        Scheduling&              accepted_sol,
-                        Scheduling&&             new_sol,
-                        std::vector<Scheduling>& history)
+inline void accept_best([[maybe_unused]] Task_table const& tasks,
+                        Scored_scheduling&                 accepted_sol,
+                        Scored_scheduling&&                new_sol,
+                        Ils_history&                       history)
 {
-  history.push_back(std::move(new_sol));
-  if (evaluate(tasks, history.back()) < evaluate(tasks, accepted_sol))
+  history.push(new_sol);
+  if (new_sol.cost < accepted_sol.cost)
   {
-    accepted_sol = history.back();
+    accepted_sol = std::move(new_sol);
   }
 }
 
 // stop function
 template <fai::Index n>
-bool stop_n_worse(fai::vector<Task> const& tasks, std::vector<Scheduling> history)
+bool stop_n_worse([[maybe_unused]] Task_table const& tasks, Ils_history const& history)
 {
-  auto it = std::min_element(std::rbegin(history),
-                             std::rend(history),
-                             [&tasks](Scheduling const& lhs, Scheduling const& rhs)
-                             { return evaluate(tasks, lhs) <= evaluate(tasks, rhs); });
-  fmt::print("stop_{}_worse: dist: {}\n", n, std::distance(std::rbegin(history), it));
-  return std::distance(std::rbegin(history), it) >= n;
+  return history.get_nb_since_best() >= n;
 }
 
+/**
+ * @brief iterated local search recording its solutions in history
+ *
+ * disturb_fn(solution, history) perturbs in place a copy of the accepted solution, the
+ * copy is made in a buffer reusing the storage of the rejected solutions
+ *
+ * @return the best solution met
+ */
 template <typename Local_search_fn,
           typename Disturb_fn,
           typename Accept_fn,
           typename Stop_fn>
-Scheduling ils(fai::vector<Task> const& tasks,
-               Scheduling               base_solution,
-               Local_search_fn&&        local_search_fn,
-               Disturb_fn&&             disturb_fn,
-               Accept_fn&&              accept_fn,
-               Stop_fn&&                stop_fn)
+Scored_scheduling ils(Task_table const& tasks,
+                      Scored_scheduling base_solution,
+                      Local_search_fn&& local_search_fn,
+                      Disturb_fn&&      disturb_fn,
+                      Accept_fn&&       accept_fn,
+                      Stop_fn&&         stop_fn,
+                      Ils_history&      history)
 {
-  std::vector<Scheduling> history;
-  Scheduling              accepted_sol = local_search_fn(tasks, std::move(base_solution));
-  history.push_back(accepted_sol);
+  Scored_scheduling accepted_sol = local_search_fn(tasks, std::move(base_solution));
+  history.push(accepted_sol);
+  Scheduling disturbed_sol;
   do
   {
-    Scheduling second_opt_sol = local_search_fn(tasks, disturb_fn(accepted_sol, history));
+    disturbed_sol.assign(std::begin(accepted_sol.solution),
+                         std::end(accepted_sol.solution));
+    disturb_fn(disturbed_sol, history);
+    // the perturbed solution is the only one evaluated from scratch
+    fai::Cost         disturbed_cost = evaluate_unchecked(tasks, disturbed_sol);
+    Scored_scheduling second_opt_sol =
+      local_search_fn(tasks, Scored_scheduling{std::move(disturbed_sol), disturbed_cost});
     accept_fn(tasks, accepted_sol, std::move(second_opt_sol), history);
+    // moved out if accepted, the next copy allocates then
+    disturbed_sol = std::move(second_opt_sol.solution);
   } while (!fai::stop_request() && !stop_fn(tasks, history));
-  return *std::min_element(std::begin(history),
-                           std::end(history),
-                           [&tasks](Scheduling const& lhs, Scheduling const& rhs)
-                           { return evaluate(tasks, lhs) < evaluate(tasks, rhs); });
-}
\ No newline at end of file
+  return history.get_best();
+}
+
+template <typename Local_search_fn,
+          typename Disturb_fn,
+          typename Accept_fn,
+          typename Stop_fn>
+Scored_scheduling ils(Task_table const& tasks,
+                      Scored_scheduling base_solution,
+                      Local_search_fn&& local_search_fn,
+                      Disturb_fn&&      disturb_fn,
+                      Accept_fn&&       accept_fn,
+                      Stop_fn&&         stop_fn)
+{
+  Ils_history history;
+  ils(tasks,
+      std::move(base_solution),
+      std::forward<Local_search_fn>(local_search_fn),
+      std::forward<Disturb_fn>(disturb_fn),
+      std::forward<Accept_fn>(accept_fn),
+      std::forward<Stop_fn>(stop_fn),
+      history);
+  return history.take_best();
+}
+
+/**
+ * @brief the islands of a parallel ILS, each one sends its best solution to the next one
+ *
+ * one mailbox per island holding the last solution sent to it, exchanged with atomic
+ * pointers: an island never waits for another one, a solution not received before the
+ * next one is sent is dropped
+ */
+class Migration_ring
+{
+private:
+  // one cache line per mailbox, the islands don't invalidate each other mailbox
+  struct alignas(64) Mailbox
+  {
+    std::atomic<Scored_scheduling*> migrant{nullptr};
+  };
+
+  std::vector<Mailbox> mailboxes;
+
+public:
+  explicit Migration_ring(std::size_t nb_islands) : mailboxes(nb_islands) {}
+
+  Migration_ring(Migration_ring const&) = delete;
+  Migration_ring& operator=(Migration_ring const&) = delete;
+
+  ~Migration_ring()
+  {
+    for (Mailbox& mailbox : mailboxes)
+    {
+      delete mailbox.migrant.load(std::memory_order_acquire);
+    }
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept
+  {
+    return mailboxes.size();
+  }
+
+  /**
+   * @brief sends solution from island to the next island of the ring
+   */
+  void send(std::size_t island, Scored_scheduling const& solution)
+  {
+    auto     migrant = std::make_unique<Scored_scheduling>(solution);
+    Mailbox& mailbox = mailboxes[(island + 1) % mailboxes.size()];
+    delete mailbox.migrant.exchange(migrant.release(), std::memory_order_acq_rel);
+  }
+
+  /**
+   * @brief the last solution sent to island, none if it was already received
+   */
+  std::unique_ptr<Scored_scheduling> receive(std::size_t island) noexcept
+  {
+    return std::unique_ptr<Scored_scheduling>(
+      mailboxes[island].migrant.exchange(nullptr, std::memory_order_acq_rel));
+  }
+};
+
+/**
+ * @brief accept function of an island: accept_fn, then every interval iterations sends
+ * the best solution of the island and accepts the received one if it is better than the
+ * accepted solution
+ */
+template <typename Accept_fn>
+class Migrating_accept
+{
+private:
+  Accept_fn       accept_fn;
+  Migration_ring& ring;
+  std::size_t     island;
+  long            interval;
+  long            nb_iterations{0};
+
+public:
+  Migrating_accept(Accept_fn accept_fn,
+                   Migration_ring& ring,
+                   std::size_t     island,
+                   long            interval)
+    : accept_fn(std::move(accept_fn)), ring(ring), island(island), interval(interval)
+  {
+  }
+
+  void operator()(Task_table const&   tasks,
+                  Scored_scheduling&  accepted_sol,
+                  Scored_scheduling&& new_sol,
+                  Ils_history&        history)
+  {
+    accept_fn(tasks, accepted_sol, std::move(new_sol), history);
+    if (++nb_iterations % interval != 0)
+    {
+      return;
+    }
+    ring.send(island, history.get_best());
+    std::unique_ptr<Scored_scheduling> migrant = ring.receive(island);
+    if (migrant && migrant->cost < accepted_sol.cost)
+    {
+      // a better migrant is met by the island: it can reset the stop criterion
+      history.push(*migrant);
+      accepted_sol = std::move(*migrant);
+    }
+  }
+};
+
+/**
+ * @brief runs nb_islands > 0 ILS in parallel, connected by a Migration_ring
+ *
+ * island_fn(island, ring) runs the ILS of the island, usually with a Migrating_accept on
+ * ring, and returns its best solution
+ *
+ * @return the best solution of the islands
+ */
+template <typename Island_fn>
+Scored_scheduling island_ils(std::size_t nb_islands, Island_fn&& island_fn)
+{
+  Migration_ring                              ring(nb_islands);
+  std::vector<std::future<Scored_scheduling>> islands;
+  islands.reserve(nb_islands);
+  for (std::size_t island = 0; island < nb_islands; ++island)
+  {
+    islands.push_back(std::async(std::launch::async,
+                                 [&ring, &island_fn, island]
+                                 { return island_fn(island, ring); }));
+  }
+  std::vector<Scored_scheduling> bests;
+  bests.reserve(nb_islands);
+  for (std::future<Scored_scheduling>& island : islands)
+  {
+    bests.push_back(island.get());
+  }
+  return std::move(*std::min_element(std::begin(bests),
+                                     std::end(bests),
+                                     [](auto const& lhs, auto const& rhs)
+                                     { return lhs.cost < rhs.cost; }));
+}
@@ -1,12 +1,20 @@
 #pragma once
 
 #include "Task.hpp"
+#include "delta_evaluation.hpp"
 #include "neighborhood.hpp"
+#include "precedence.hpp"
+#include "search_stats.hpp"
+#include "thread_pool.hpp"
 #include "utils.hpp"
 
 #include <fmt/core.h>
 
-#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <type_traits>
+#include <vector>
 
 struct Select2_ret
 {
@@ -17,33 +25,297 @@ struct Select2_ret
   bool brk{false};
 };
 
-using Select2_fn_t = Select2_ret (*)(fai::vector<Task> const& tasks,
-                                     Scheduling&              lhs,
-                                     Scheduling const&        rhs,
-                                     fai::Index               imp_neigh_no);
+using Select2_fn_t = Select2_ret (*)(Task_table const&  tasks,
+                                     Scored_move&       lhs,
+                                     Scored_move const& rhs,
+                                     fai::Index         imp_neigh_no);
 
+/**
+ * @brief optional helpers of the local searches
+ */
+struct Search_options
+{
+  // when it has more than one thread, large neighborhoods are scanned by
+  // parallel_next_neighbor
+  Thread_pool* pool{nullptr};
+  // the adjacent interchanges breaking a proven task order are skipped without being
+  // evaluated
+  Precedence_table const* precedences{nullptr};
+  // progress of the search, for a Stats_reporter
+  Search_counters* counters{nullptr};
+};
+
+/**
+ * @brief first improvement resuming where the previous scan of the search stopped
+ *
+ * a local search using it starts each scan at the index of the last applied move and
+ * wraps around, so it stops after a full pass without better neighbor instead of scanning
+ * the first moves again after each improvement
+ */
+struct select2first_circular
+{
+  inline Select2_ret operator()([[maybe_unused]] Task_table const&  tasks,
+                                [[maybe_unused]] Scored_move&       lhs,
+                                [[maybe_unused]] Scored_move const& rhs,
+                                [[maybe_unused]] fai::Index         imp_neigh_no) const
+  {
+    return {Select2_ret::BREAK};
+  }
+};
+
+template <typename Select2_fn>
+inline constexpr bool is_circular_select_v =
+  std::is_same_v<std::decay_t<Select2_fn>, select2first_circular>;
+
+// defined with the other select functions
+inline Select2_ret select2first(Task_table const&  tasks,
+                                Scored_move&       lhs,
+                                Scored_move const& rhs,
+                                fai::Index         imp_neigh_no);
+
+/**
+ * @brief whether select breaks whatever the second improving move is, so the first
+ * improving move of a scan is the selected one
+ *
+ * select2first is a plain function like select2best, so it is told apart by address
+ */
+template <typename Select2_fn>
+constexpr bool is_first_select(Select2_fn const& select)
+{
+  if constexpr (is_circular_select_v<Select2_fn>)
+  {
+    return true;
+  }
+  else if constexpr (std::is_convertible_v<Select2_fn const&, Select2_fn_t>)
+  {
+    return static_cast<Select2_fn_t>(select) == &select2first;
+  }
+  else
+  {
+    return false;
+  }
+}
+
+// smallest number of moves scanned by a thread in one go
+inline constexpr fai::Index parallel_scan_min_chunk = 1024;
+// chunks per thread: the first chunks are scanned first, with a first select the first
+// improving move found cancels the chunks after its own
+inline constexpr fai::Index parallel_scan_chunks_per_thread = 8;
+
+/**
+ * @brief next_neighbor with the moves split in chunks scanned by the threads of pool
+ *
+ * each chunk selects its move as the sequential scan does, then the chunks are combined
+ * in the traversal order with select: select2best and select2first give the same move as
+ * the sequential scan. Once select breaks in a chunk, the chunks after it are cancelled,
+ * with a first select (is_first_select) as soon as the chunk finds an improving move.
+ * select2best_nfirst<n> counts the improving neighbors per chunk
+ *
+ * the traversal starts at the move start and wraps around
+ */
 template <typename Neigh_op, typename Select2_fn>
-Scheduling next_neighbor(fai::vector<Task> const& tasks,
-                         Neigh_op&                neigh_op,
-                         Select2_fn&&             select)
+std::optional<Scored_move> parallel_next_neighbor(Task_table const&     tasks,
+                                                  Neigh_op&             neigh_op,
+                                                  Select2_fn&&          select,
+                                                  Thread_pool&          pool,
+                                                  Search_options const& options = {},
+                                                  fai::Index            start = 0)
 {
-  fai::Cost base_cost = evaluate(tasks, neigh_op.get_base_solution());
+  Prefix_evaluation base_eval(tasks, neigh_op.get_base_solution());
+  fai::Cost         base_cost = base_eval.get_cost();
+  std::optional<Precedence_filter> filter;
+  if (options.precedences != nullptr)
+  {
+    filter.emplace(*options.precedences, neigh_op.get_base_solution());
+  }
+
+  fai::Index nb_moves = neigh_op.size();
+  fai::Index nb_chunks = std::clamp(nb_moves / parallel_scan_min_chunk,
+                                    fai::Index{1},
+                                    pool.size() * parallel_scan_chunks_per_thread);
+  fai::Index chunk_size = (nb_moves + nb_chunks - 1) / nb_chunks;
+
+  struct Chunk_result
+  {
+    std::optional<Scored_move> selected;
+    long                       nb_neigh{0};
+    long                       nb_pruned{0};
+  };
+  std::vector<Chunk_result> results(static_cast<std::size_t>(nb_chunks));
+  std::atomic<fai::Index>   next_chunk{0};
+  // first chunk where select broke, the chunks after it can't be selected
+  std::atomic<fai::Index> break_chunk{nb_chunks};
+
+  auto is_cancelled = [&break_chunk](fai::Index chunk)
+  { return break_chunk.load(std::memory_order_relaxed) < chunk; };
+  auto cancel_after = [&break_chunk](fai::Index chunk)
+  {
+    fai::Index prev = break_chunk.load();
+    while (chunk < prev && !break_chunk.compare_exchange_weak(prev, chunk))
+    {
+    }
+  };
+  bool const first_select = is_first_select(select);
+
+  pool.run(
+    [&](fai::Index)
+    {
+      for (fai::Index chunk = next_chunk++; chunk < nb_chunks && !is_cancelled(chunk);
+           chunk = next_chunk++)
+      {
+        Chunk_result& result = results[static_cast<std::size_t>(chunk)];
+        fai::Index    idx = chunk * chunk_size;
+        fai::Index    chunk_end = std::min(idx + chunk_size, nb_moves);
+        fai::Index    nb_imp_neigh = 0;
+        // idx counts from start, move_no from the first move of neigh_op
+        fai::Index move_no = (start + idx) % nb_moves;
+        auto       it = begin_moves(neigh_op);
+        it += move_no;
+        for (; idx < chunk_end && !is_cancelled(chunk); ++it, ++idx, ++move_no)
+        {
+          if (move_no == nb_moves)
+          {
+            it = begin_moves(neigh_op);
+            move_no = 0;
+          }
+          if (filter && filter->breaks(*it))
+          {
+            ++result.nb_pruned;
+            continue;
+          }
+          ++result.nb_neigh;
+          if (fai::Cost curr_cost = it.get_cost(base_eval); //
+              curr_cost < base_cost)
+          {
+            Scored_move neigh_move{*it, curr_cost};
+            if (!result.selected)
+            {
+              result.selected = neigh_move;
+              if (first_select)
+              {
+                // the combine step selects it and breaks on the next one
+                cancel_after(chunk);
+                break;
+              }
+            }
+            else
+            {
+              if (select(tasks, *result.selected, neigh_move, nb_imp_neigh).brk)
+              {
+                cancel_after(chunk);
+                break;
+              }
+              ++nb_imp_neigh;
+            }
+          }
+        }
+      }
+    });
+
+  if (options.counters != nullptr)
+  {
+    // the cancelled chunks were partly scanned too
+    long nb_neigh = 0;
+    long nb_pruned = 0;
+    for (Chunk_result const& result : results)
+    {
+      nb_neigh += result.nb_neigh;
+      nb_pruned += result.nb_pruned;
+    }
+    options.counters->add_scan(nb_neigh, nb_pruned);
+  }
+
+  std::optional<Scored_move> selected_neigh;
+  fai::Index                 nb_imp_neigh = 0;
+  fai::Index                 last_chunk = std::min(break_chunk.load(), nb_chunks - 1);
+  for (fai::Index chunk = 0; chunk <= last_chunk; ++chunk)
+  {
+    Chunk_result const& result = results[static_cast<std::size_t>(chunk)];
+    if (!result.selected)
+    {
+      continue;
+    }
+    if (!selected_neigh)
+    {
+      selected_neigh = result.selected;
+    }
+    else
+    {
+      if (select(tasks, *selected_neigh, *result.selected, nb_imp_neigh).brk)
+      {
+        break;
+      }
+      ++nb_imp_neigh;
+    }
+  }
+  return selected_neigh;
+}
 
-  Scheduling selected_neigh;
-  long       nb_neigh = 0;
-  fai::Index nb_imp_neigh = 0;
-  for (auto const& neigh_sol : neigh_op)
+/**
+ * @brief next_neighbor with the traversal starting at the move start of neigh_op and
+ * wrapping around
+ */
+template <typename Neigh_op, typename Select2_fn>
+std::optional<Scored_move> next_neighbor_from(Task_table const&     tasks,
+                                              Neigh_op&             neigh_op,
+                                              Select2_fn&&          select,
+                                              fai::Index            start,
+                                              Search_options const& options = {})
+{
+  fai::Index nb_moves = neigh_op.size();
+  if (options.pool != nullptr && options.pool->size() > 1 &&
+      nb_moves >= 2 * parallel_scan_min_chunk)
   {
-    if (fai::Cost curr_cost = evaluate(tasks, neigh_sol); //
+    return parallel_next_neighbor(tasks, neigh_op, select, *options.pool, options, start);
+  }
+
+  // the base solution is fully evaluated once, the neighbors only by what they change
+  Prefix_evaluation base_eval(tasks, neigh_op.get_base_solution());
+  fai::Cost         base_cost = base_eval.get_cost();
+  std::optional<Precedence_filter> filter;
+  if (options.precedences != nullptr)
+  {
+    filter.emplace(*options.precedences, neigh_op.get_base_solution());
+  }
+
+  std::optional<Scored_move> selected_neigh;
+  long                       nb_neigh = 0;
+  long                       nb_pruned = 0;
+  fai::Index                 nb_imp_neigh = 0;
+  bool const                 first_select = is_first_select(select);
+  fai::Index                 move_no = start;
+  auto                       it = begin_moves(neigh_op);
+  it += move_no;
+  for (fai::Index idx = 0; idx < nb_moves; ++it, ++idx, ++move_no)
+  {
+    if (move_no == nb_moves)
+    {
+      it = begin_moves(neigh_op);
+      move_no = 0;
+    }
+    if (filter && filter->breaks(*it))
+    {
+      ++nb_pruned;
+      continue;
+    }
+    // counted before the evaluation like in parallel_next_neighbor
+    ++nb_neigh;
+    if (fai::Cost curr_cost = it.get_cost(base_eval); //
         curr_cost < base_cost)
     {
-      if (selected_neigh.empty())
+      Scored_move neigh_move{*it, curr_cost};
+      if (!selected_neigh)
       {
-        selected_neigh = neigh_sol;
+        selected_neigh = neigh_move;
+        if (first_select)
+        {
+          // stops where parallel_next_neighbor does
+          break;
+        }
       }
       else
       {
-        Select2_ret select_ret = select(tasks, selected_neigh, neigh_sol, nb_imp_neigh);
+        Select2_ret select_ret = select(tasks, *selected_neigh, neigh_move, nb_imp_neigh);
         if (select_ret.brk)
         {
           break;
@@ -51,113 +323,207 @@ Scheduling next_neighbor(fai::vector<Task> const& tasks,
         ++nb_imp_neigh;
       }
     }
-    ++nb_neigh;
   }
-  fmt::print(" -> treated {} neighbors\n", nb_neigh);
+  if (options.counters != nullptr)
+  {
+    options.counters->add_scan(nb_neigh, nb_pruned);
+  }
   return selected_neigh;
 }
 
-template <typename Select2_fn>
-inline Scheduling vnd(fai::vector<Task> const& tasks,
-                      Scheduling               base_solution,
-                      Select2_fn&&             select)
+/**
+ * @brief select a move of neigh_op leading to a better neighbor than its base solution
+ *
+ * the base solution isn't modified, apply the move to commit it
+ *
+ * @return the selected move, none if no neighbor is better
+ */
+template <typename Neigh_op, typename Select2_fn>
+std::optional<Scored_move> next_neighbor(Task_table const&     tasks,
+                                         Neigh_op&             neigh_op,
+                                         Select2_fn&&          select,
+                                         Search_options const& options = {})
 {
-  while (true)
+  return next_neighbor_from(tasks, neigh_op, select, 0, options);
+}
+
+/**
+ * @brief next_neighbor_from in the Neighborhood of solution, solution is lent to the
+ * neighborhood for the scan and given back unchanged
+ *
+ * with a circular select, start becomes the index of the selected move
+ */
+template <typename Neighborhood, typename Select2_fn>
+std::optional<Scored_move> next_neighbor_in(Task_table const&     tasks,
+                                            Scheduling&           solution,
+                                            Select2_fn&&          select,
+                                            fai::Index&           start,
+                                            Search_options const& options)
+{
+  Neighborhood               nbh(std::move(solution));
+  std::optional<Scored_move> selected_neigh =
+    next_neighbor_from(tasks, nbh, select, start, options);
+  if constexpr (is_circular_select_v<Select2_fn>)
   {
-    Consecutive_single_swap_neighborhood n1(base_solution);
+    if (selected_neigh)
+    {
+      start = nbh.index_of(selected_neigh->move);
+    }
+  }
+  solution = std::move(nbh.get_base_solution());
+  return selected_neigh;
+}
 
-    fai::Cost  base_cost = evaluate(tasks, base_solution);
-    Scheduling selected_neigh = next_neighbor(tasks, n1, select);
+template <typename... Neighborhoods>
+std::string get_vnd_name()
+{
+  std::string const names[]{get_neighborhood_name<Neighborhoods>()...};
+  return fmt::format("VND {}", fmt::join(std::begin(names), std::end(names), " -> "));
+}
 
-    if (selected_neigh.empty())
+template <typename... Neighborhoods>
+std::string get_vnd_short_name()
+{
+  std::string const names[]{get_neighborhood_short_name<Neighborhoods>()...};
+  return fmt::format("vnd_{}", fmt::join(std::begin(names), std::end(names), "_"));
+}
+
+/**
+ * @brief variable neighborhood descent on Neighborhoods, from the cheapest to scan to the
+ * most expensive one
+ *
+ * a neighborhood is only scanned once the previous ones have no better neighbor, any
+ * improvement goes back to the first neighborhood: the result is a local optimum of all
+ * of them
+ */
+template <typename... Neighborhoods, typename Select2_fn>
+Scored_scheduling vnd(Task_table const&     tasks,
+                      Scored_scheduling     base_solution,
+                      Select2_fn&&          select,
+                      Search_options const& options = {})
+{
+  static_assert(sizeof...(Neighborhoods) > 0, "vnd needs at least one neighborhood");
+  constexpr fai::Index nb_neighborhoods = sizeof...(Neighborhoods);
+  // each scan is statically dispatched, only the choice of the neighborhood is indirect
+  using Next_neighbor_fn = std::optional<Scored_move> (*)(Task_table const&,
+                                                          Scheduling&,
+                                                          Select2_fn&,
+                                                          fai::Index&,
+                                                          Search_options const&);
+  Next_neighbor_fn const next_neighbor_fns[]{
+    &next_neighbor_in<Neighborhoods, Select2_fn&>...};
+
+  if (options.counters != nullptr)
+  {
+    options.counters->update_best(base_solution.cost);
+  }
+  // where the scans of each neighborhood start, always 0 unless select is circular
+  fai::Index starts[sizeof...(Neighborhoods)]{};
+  fai::Index nbh_no = 0;
+  while (nbh_no < nb_neighborhoods)
+  {
+    std::optional<Scored_move> selected_neigh = next_neighbor_fns[nbh_no](
+      tasks, base_solution.solution, select, starts[nbh_no], options);
+
+    if (!selected_neigh)
     {
-      // change neighborhood
-      // if no more neighborhood; end
-      return base_solution;
+      // local optimum of this neighborhood, escalate to the next one
+      ++nbh_no;
+      continue;
     }
-    else
+
+    apply_move(base_solution.solution, selected_neigh->move);
+    base_solution.cost = selected_neigh->cost;
+    nbh_no = 0;
+    if (options.counters != nullptr)
     {
-      base_solution = selected_neigh;
+      options.counters->add_improvement(base_solution.cost);
+    }
+    if (fai::stop_request())
+    {
+      fmt::print("\nStopped at {} with:\n  {}\n",
+                 base_solution.cost,
+                 base_solution.solution);
+      return base_solution;
     }
   }
+  return base_solution;
 }
 
 template <typename Neighborhood, typename Select2_fn>
-Scheduling hill_climbing(fai::vector<Task> const& tasks,
-                         Scheduling               base_solution,
-                         Select2_fn&&             select)
+Scored_scheduling hill_climbing(Task_table const&     tasks,
+                                Scored_scheduling     base_solution,
+                                Select2_fn&&          select,
+                                Search_options const& options = {})
 {
-  fmt::print("hill_climbing with {}\n", get_neighborhood_name<Neighborhood>());
-  long nb_loop = 0;
-  auto start_time = std::chrono::steady_clock::now();
+  if (options.counters != nullptr)
+  {
+    options.counters->update_best(base_solution.cost);
+  }
+  // where the scans start, always 0 unless select is circular
+  fai::Index start = 0;
   while (true)
   {
-    fai::Cost    base_cost = evaluate(tasks, base_solution);
-    Neighborhood n1(std::move(base_solution));
+    fai::Cost    base_cost = base_solution.cost;
+    Neighborhood n1(std::move(base_solution.solution));
 
-    std::chrono::duration<double> time_since_start =
-      std::chrono::steady_clock::now() - start_time;
-    fmt::print("hc_{}: Solution is at {:L} {:.2f} loop/s",
-               get_neighborhood_short_name<Neighborhood>(),
-               base_cost,
-               nb_loop / time_since_start.count());
-    Scheduling selected_neigh = next_neighbor(tasks, n1, select);
+    std::optional<Scored_move> selected_neigh =
+      next_neighbor_from(tasks, n1, select, start, options);
 
-    if (selected_neigh.empty())
+    if (!selected_neigh)
     {
       // no more better neighbors
-      return n1.get_base_solution();
+      return {std::move(n1.get_base_solution()), base_cost};
     }
-    else if (fai::stop_request())
+    if constexpr (is_circular_select_v<Select2_fn>)
     {
-      fmt::print("\nStopped at {} with:\n  {}\n",
-                 evaluate(tasks, selected_neigh),
-                 selected_neigh);
-      return selected_neigh;
+      start = n1.index_of(selected_neigh->move);
     }
-    else
+
+    // commit the selected move
+    apply_move(n1.get_base_solution(), selected_neigh->move);
+    base_solution = {std::move(n1.get_base_solution()), selected_neigh->cost};
+    if (options.counters != nullptr)
+    {
+      options.counters->add_improvement(base_solution.cost);
+    }
+    if (fai::stop_request())
     {
-      base_solution = std::move(selected_neigh);
+      fmt::print("\nStopped at {} with:\n  {}\n",
+                 base_solution.cost,
+                 base_solution.solution);
+      return base_solution;
     }
-    ++nb_loop;
-    // if (nb_loop >= 500)
-    // {
-    //   std::chrono::duration<double> time_since_start =
-    //     std::chrono::steady_clock::now() - start_time;
-    //   fmt::print("reset after: {:.2f}s\n", time_since_start.count());
-    //   nb_loop = 0;
-    //   start_time = std::chrono::steady_clock::now();
-    // }
   }
 }
 
-inline Select2_ret select2best(fai::vector<Task> const&    tasks,
-                               Scheduling&                 lhs,
-                               Scheduling const&           rhs,
-                               [[maybe_unused]] fai::Index imp_neigh_no)
+inline Select2_ret select2best([[maybe_unused]] Task_table const& tasks,
+                               Scored_move&                       lhs,
+                               Scored_move const&                 rhs,
+                               [[maybe_unused]] fai::Index        imp_neigh_no)
 {
-  if (evaluate(tasks, lhs) > evaluate(tasks, rhs))
+  if (lhs.cost > rhs.cost)
   {
     lhs = rhs;
   }
   return {};
 }
 
-inline Select2_ret select2worst(fai::vector<Task> const&    tasks,
-                                Scheduling&                 lhs,
-                                Scheduling const&           rhs,
-                                [[maybe_unused]] fai::Index imp_neigh_no)
+inline Select2_ret select2worst([[maybe_unused]] Task_table const& tasks,
+                                Scored_move&                       lhs,
+                                Scored_move const&                 rhs,
+                                [[maybe_unused]] fai::Index        imp_neigh_no)
 {
-  if (evaluate(tasks, lhs) < evaluate(tasks, rhs))
+  if (lhs.cost < rhs.cost)
   {
     lhs = rhs;
   }
   return {};
 }
 
-inline Select2_ret select2first(fai::vector<Task> const&    tasks,
-                                Scheduling&                 lhs,
-                                Scheduling const&           rhs,
+inline Select2_ret select2first(Task_table const&           tasks,
+                                Scored_move&                lhs,
+                                Scored_move const&          rhs,
                                 [[maybe_unused]] fai::Index imp_neigh_no)
 {
   return {Select2_ret::BREAK};
@@ -171,12 +537,12 @@ struct select2best_nfirst
     return n;
   }
 
-  inline Select2_ret operator()(fai::vector<Task> const&    tasks,
-                                Scheduling&                 lhs,
-                                Scheduling const&           rhs,
-                                [[maybe_unused]] fai::Index imp_neigh_no) const
+  inline Select2_ret operator()([[maybe_unused]] Task_table const& tasks,
+                                Scored_move&                       lhs,
+                                Scored_move const&                 rhs,
+                                [[maybe_unused]] fai::Index        imp_neigh_no) const
   {
-    if (evaluate(tasks, lhs) > evaluate(tasks, rhs))
+    if (lhs.cost > rhs.cost)
     {
       lhs = rhs;
     }
@@ -225,3 +591,8 @@ std::string select_fn_name(select2best_nfirst<n>& fn)
 {
   return fmt::format("sbestIn{}", n);
 }
+
+inline std::string select_fn_name([[maybe_unused]] select2first_circular& fn)
+{
+  return "sfirstCirc";
+}
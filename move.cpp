@@ -0,0 +1 @@
+#include "move.hpp"
\ No newline at end of file
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "Task.hpp"
+#include "utils.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <utility>
+
+/**
+ * @brief move of a neighborhood, describes a neighbor from the base solution
+ *
+ * neighborhoods enumerate moves instead of neighbors: a move is a few integers, cheap
+ * to copy, to store or to send to another thread, the solution is only modified when a
+ * move is committed with apply_move
+ */
+struct Move
+{
+  enum class Type : std::uint8_t
+  {
+    // swap the tasks at beg and end - 1
+    swap,
+    // reverse the block [beg, end)
+    reverse,
+    // rotate the block [beg, end) so that the task at middle becomes the first one
+    rotate,
+  };
+
+  Type       type{Type::swap};
+  fai::Index beg{0};
+  fai::Index end{0};
+  fai::Index middle{0};
+
+  [[nodiscard]] static constexpr Move swap(fai::Index pos) noexcept
+  {
+    return swap(pos, pos + 1);
+  }
+
+  [[nodiscard]] static constexpr Move swap(fai::Index first, fai::Index second) noexcept
+  {
+    return {Type::swap, first, second + 1};
+  }
+
+  [[nodiscard]] static constexpr Move reverse(fai::Index beg, fai::Index end) noexcept
+  {
+    return {Type::reverse, beg, end};
+  }
+
+  /**
+   * @brief move the block of size len at from, without reversing it, so that it starts
+   * at position to
+   */
+  [[nodiscard]] static constexpr Move block_move(fai::Index from,
+                                                 fai::Index len,
+                                                 fai::Index to) noexcept
+  {
+    // forward the block rotates left by len, backward right by len
+    return from < to ? Move{Type::rotate, from, to + len, from + len}
+                     : Move{Type::rotate, to, from + len, from};
+  }
+
+  /**
+   * @brief remove the task at from and insert it back at position to
+   */
+  [[nodiscard]] static constexpr Move insertion(fai::Index from, fai::Index to) noexcept
+  {
+    return block_move(from, 1, to);
+  }
+
+  friend constexpr bool operator==(Move const& lhs, Move const& rhs) noexcept
+  {
+    return lhs.type == rhs.type && lhs.beg == rhs.beg && lhs.end == rhs.end &&
+           lhs.middle == rhs.middle;
+  }
+
+  friend constexpr bool operator!=(Move const& lhs, Move const& rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+};
+
+/**
+ * @brief a move with the cost of the neighbor it leads to
+ */
+struct Scored_move
+{
+  Move      move;
+  fai::Cost cost;
+};
+
+/**
+ * @brief commit a move: solution becomes the neighbor described by move
+ */
+inline void apply_move(Scheduling& solution, Move const& move)
+{
+  switch (move.type)
+  {
+  case Move::Type::swap:
+    std::swap(solution[move.beg], solution[move.end - 1]);
+    break;
+  case Move::Type::reverse:
+    std::reverse(std::next(std::begin(solution), move.beg),
+                 std::next(std::begin(solution), move.end));
+    break;
+  case Move::Type::rotate:
+    std::rotate(std::next(std::begin(solution), move.beg),
+                std::next(std::begin(solution), move.middle),
+                std::next(std::begin(solution), move.end));
+    break;
+  }
+}
+
+inline std::string_view get_move_type_name(Move::Type type) noexcept
+{
+  switch (type)
+  {
+  case Move::Type::swap:
+    return "swap";
+  case Move::Type::reverse:
+    return "reverse";
+  case Move::Type::rotate:
+    return "rotate";
+  }
+  return "unknown";
+}
+
+template <>
+struct fmt::formatter<Move>
+{
+  constexpr auto parse(format_parse_context& ctx)
+  {
+    return ctx.begin();
+  }
+
+  template <typename Format_context>
+  auto format(Move const& move, Format_context& ctx) const
+  {
+    if (move.type == Move::Type::rotate)
+    {
+      return fmt::format_to(ctx.out(),
+                            "rotate({}, {}, {})",
+                            move.beg,
+                            move.middle,
+                            move.end);
+    }
+    return fmt::format_to(ctx.out(),
+                          "{}({}, {})",
+                          get_move_type_name(move.type),
+                          move.beg,
+                          move.end);
+  }
+};
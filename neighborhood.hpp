@@ -1,25 +1,80 @@
 #pragma once
 
 #include "Task.hpp"
+#include "delta_evaluation.hpp"
+#include "move.hpp"
 #include "utils.hpp"
 
 #include <fmt/core.h>
 #include <fmt/ranges.h>
 
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <tuple>
 #include <utility>
 
+/**
+ * @brief number of moves before the group j, when the group i has m - i moves
+ */
+constexpr std::int64_t triangular_offset(std::int64_t m, std::int64_t j) noexcept
+{
+  return j * m - j * (j - 1) / 2;
+}
+
+/**
+ * @brief group of the idx-th move: the last j with triangular_offset(m, j) <= idx
+ *
+ * root of j^2 - (2m + 1)j + 2idx = 0, corrected for the floating point rounding: O(1)
+ */
+inline fai::Index triangular_group(fai::Index m, fai::Index idx) noexcept
+{
+  double b = 2. * m + 1.;
+  auto   j = static_cast<fai::Index>((b - std::sqrt(b * b - 8. * idx)) / 2.);
+  while (j > 0 && triangular_offset(m, j) > idx)
+  {
+    --j;
+  }
+  while (triangular_offset(m, j + 1) <= idx)
+  {
+    ++j;
+  }
+  return j;
+}
+
+/**
+ * @brief sum of min(bound, k) for k in [0, x): number of moves before the group x when
+ * the group k has min(bound, k) moves
+ */
+constexpr std::int64_t bounded_triangular_sum(std::int64_t bound, std::int64_t x) noexcept
+{
+  if (x - 1 <= bound)
+  {
+    return x * (x - 1) / 2;
+  }
+  return bound * (bound + 1) / 2 + (x - 1 - bound) * bound;
+}
+
 class Neighborhood_abstract
 {
 public:
   virtual ~Neighborhood_abstract() = default;
 
 protected:
+  // to construct a cursor at the last move
+  static constexpr struct Reverse_tag
+  {
+  } reverse_tag{};
+
+  /**
+   * @brief position in the moves of a neighborhood
+   *
+   * the iterators only hold the indices of the current move, the base solution is never
+   * copied nor modified while iterating
+   */
   class Polymorphic_iterator
   {
   public:
-    static constexpr struct Reverse_tag
-    {
-    } reverse_tag{};
     virtual ~Polymorphic_iterator() = default;
 
     virtual void advance()
@@ -34,7 +89,22 @@ protected:
       move_by(-1);
     }
 
-    virtual Scheduling const& get_current_neighbor() const noexcept = 0;
+    [[nodiscard]] virtual Move get_current_move() const noexcept = 0;
+
+    /**
+     * @brief cost of the neighbor the current move leads to
+     *
+     * default to the delta evaluation of the move, override it to reuse the cost of the
+     * previous moves
+     *
+     * @param base_eval evaluation of the base solution of the neighborhood
+     * @return fai::Cost
+     */
+    [[nodiscard]] virtual fai::Cost get_current_cost(
+      Prefix_evaluation const& base_eval) const
+    {
+      return base_eval.get_neighbor_cost(get_current_move());
+    }
 
     /**
      * @brief end (could be forward or reverse)
@@ -82,9 +152,15 @@ protected:
       Polymorphic_derived_iterator::advance();
     }
 
-    Scheduling const& get_current_neighbor() const noexcept override
+    [[nodiscard]] Move get_current_move() const noexcept override
+    {
+      return Polymorphic_derived_iterator::get_current_move();
+    }
+
+    [[nodiscard]] fai::Cost get_current_cost(
+      Prefix_evaluation const& base_eval) const override
     {
-      return Polymorphic_derived_iterator::get_current_neighbor();
+      return Polymorphic_derived_iterator::get_current_cost(base_eval);
     }
 
     [[nodiscard]] bool is_end() const noexcept override
@@ -93,6 +169,61 @@ protected:
     }
   };
 
+  /**
+   * @brief type erased cursor, a cursor is the concrete iterator of a neighborhood
+   *
+   * a cursor has the non virtual members of Polymorphic_iterator (but is_end), so it can
+   * also be used without indirection by Static_iterator
+   */
+  template <class Cursor>
+  class Polymorphic_cursor : public Polymorphic_iterator
+  {
+  private:
+    Cursor cursor;
+
+  public:
+    template <typename... Args>
+    explicit Polymorphic_cursor(Args&&... args) : cursor(std::forward<Args>(args)...)
+    {
+    }
+
+    void advance() override
+    {
+      cursor.advance();
+    }
+
+    void move_by(int dist) override
+    {
+      cursor.move_by(dist);
+    }
+
+    void go_back() override
+    {
+      cursor.go_back();
+    }
+
+    [[nodiscard]] Move get_current_move() const noexcept override
+    {
+      return cursor.get_current_move();
+    }
+
+    [[nodiscard]] fai::Cost get_current_cost(
+      Prefix_evaluation const& base_eval) const override
+    {
+      return cursor.get_current_cost(base_eval);
+    }
+
+    [[nodiscard]] bool is_fend() const noexcept override
+    {
+      return cursor.is_fend();
+    }
+
+    [[nodiscard]] bool is_rend() const noexcept override
+    {
+      return cursor.is_rend();
+    }
+  };
+
 public:
   struct End_sentinel
   {
@@ -118,15 +249,17 @@ public:
       return *this;
     }
 
-    // Scheduling const& operator[](int dist) const
-    // {
-    //   it->move_by(dist);
-    //   return it->get_current_neighbor();
-    // }
+    /**
+     * @brief the current move, apply it to the base solution to get the neighbor
+     */
+    Move operator*() const noexcept
+    {
+      return it->get_current_move();
+    }
 
-    Scheduling const& operator*() const noexcept
+    [[nodiscard]] fai::Cost get_cost(Prefix_evaluation const& base_eval) const
     {
-      return it->get_current_neighbor();
+      return it->get_current_cost(base_eval);
     }
 
     bool operator==(End_sentinel rhs) const noexcept
@@ -140,6 +273,63 @@ public:
     }
   };
 
+  /**
+   * @brief iterator on a cursor whose type is known at compile time
+   *
+   * same interface as Iterator without the heap allocation and the virtual calls, so the
+   * traversal and the delta evaluation can be inlined in the search loop
+   *
+   * @tparam backward to go from the last move to the first one
+   */
+  template <class Cursor, bool backward = false>
+  class Static_iterator
+  {
+  private:
+    Cursor cursor;
+
+  public:
+    explicit Static_iterator(Cursor cursor) : cursor(std::move(cursor)) {}
+
+    Static_iterator& operator++()
+    {
+      if constexpr (backward)
+      {
+        cursor.go_back();
+      }
+      else
+      {
+        cursor.advance();
+      }
+      return *this;
+    }
+
+    Static_iterator& operator+=(int dist)
+    {
+      cursor.move_by(backward ? -dist : dist);
+      return *this;
+    }
+
+    Move operator*() const noexcept
+    {
+      return cursor.get_current_move();
+    }
+
+    [[nodiscard]] fai::Cost get_cost(Prefix_evaluation const& base_eval) const
+    {
+      return cursor.get_current_cost(base_eval);
+    }
+
+    bool operator==([[maybe_unused]] End_sentinel rhs) const noexcept
+    {
+      return backward ? cursor.is_rend() : cursor.is_fend();
+    }
+
+    bool operator!=(End_sentinel rhs) const noexcept
+    {
+      return !(*this == rhs);
+    }
+  };
+
   virtual Iterator begin() noexcept = 0;
   virtual Iterator rbegin() noexcept = 0;
 
@@ -153,10 +343,15 @@ public:
     return {};
   }
 
-  Scheduling at(fai::Index idx)
-  {
-    return *(begin() += idx);
-  }
+  /**
+   * @brief the idx-th move of the traversal, O(1)
+   */
+  [[nodiscard]] virtual Move at(fai::Index idx) const noexcept = 0;
+
+  /**
+   * @brief position of move in the traversal, inverse of at, O(1)
+   */
+  [[nodiscard]] virtual fai::Index index_of(Move const& move) const noexcept = 0;
 
   virtual Scheduling& get_base_solution() noexcept = 0;
 
@@ -199,68 +394,52 @@ public:
   using Neighborhood_base::Neighborhood_base;
 
 private:
-  class Iterator_derived : public Polymorphic_iterator
+  class Cursor
   {
   private:
-    Scheduling solution;
+    fai::Index nb_tasks;
     fai::Index modif_pos{0};
 
   public:
-    explicit Iterator_derived(Scheduling const& base_sol) : solution(base_sol)
-    {
-      std::swap(solution[modif_pos], solution[modif_pos + 1]);
-    }
-    Iterator_derived(Scheduling const& base_sol, Reverse_tag)
-      : solution(base_sol), modif_pos(solution.size() - 2)
+    explicit Cursor(fai::Index nb_tasks) : nb_tasks(nb_tasks) {}
+
+    Cursor(fai::Index nb_tasks, Reverse_tag)
+      : nb_tasks(nb_tasks), modif_pos(nb_tasks - 2)
     {
-      std::swap(solution[modif_pos], solution[modif_pos + 1]);
     }
 
-    void advance() override
+    void advance()
     {
       ++modif_pos;
-      if (!is_fend())
-      {
-        std::swap(solution[modif_pos - 1], solution[modif_pos]);
-        std::swap(solution[modif_pos], solution[modif_pos + 1]);
-      }
     }
 
-    void move_by(int dist) override
+    void move_by(int dist)
     {
-      if (dist == 0)
-      {
-        return;
-      }
-
-      // restore
-      std::swap(solution[modif_pos], solution[modif_pos + 1]);
-
       modif_pos += dist;
-      std::swap(solution[modif_pos], solution[modif_pos + 1]);
     }
 
-    void go_back() override
+    void go_back()
     {
       --modif_pos;
-      if (!is_rend())
-      {
-        std::swap(solution[modif_pos + 1], solution[modif_pos + 2]);
-        std::swap(solution[modif_pos], solution[modif_pos + 1]);
-      }
     }
 
-    Scheduling const& get_current_neighbor() const noexcept override
+    [[nodiscard]] Move get_current_move() const noexcept
     {
-      return solution;
+      return get_move(nb_tasks, modif_pos);
     }
 
-    [[nodiscard]] bool is_fend() const noexcept override
+    [[nodiscard]] fai::Cost get_current_cost(Prefix_evaluation const& base_eval) const
     {
-      return modif_pos >= solution.size() - 1;
+      // only the 2 swapped tasks change their start time: O(1)
+      return base_eval.get_neighbor_cost(get_current_move());
     }
 
-    [[nodiscard]] bool is_rend() const noexcept override
+    [[nodiscard]] bool is_fend() const noexcept
+    {
+      return modif_pos >= nb_tasks - 1;
+    }
+
+    [[nodiscard]] bool is_rend() const noexcept
     {
       return modif_pos < 0;
     }
@@ -269,19 +448,59 @@ private:
 public:
   Iterator begin() noexcept override
   {
-    return Iterator(std::make_unique<Iterator_derived>(get_base_solution()));
+    return Iterator(
+      std::make_unique<Polymorphic_cursor<Cursor>>(get_base_solution().size()));
   }
 
   Iterator rbegin() noexcept override
   {
-    return Iterator(std::make_unique<Polymorphic_reverse_iterator<Iterator_derived>>(
-      get_base_solution(),
-      Iterator_derived::reverse_tag));
+    return Iterator(
+      std::make_unique<Polymorphic_reverse_iterator<Polymorphic_cursor<Cursor>>>(
+        get_base_solution().size(),
+        reverse_tag));
+  }
+
+  Static_iterator<Cursor> static_begin() const noexcept
+  {
+    return Static_iterator<Cursor>(Cursor(get_base_solution().size()));
+  }
+
+  Static_iterator<Cursor, true> static_rbegin() const noexcept
+  {
+    return Static_iterator<Cursor, true>(
+      Cursor(get_base_solution().size(), reverse_tag));
   }
 
   fai::Index size() const noexcept override
   {
-    return (get_base_solution().size() - 1);
+    return get_size(get_base_solution().size());
+  }
+
+  [[nodiscard]] Move at(fai::Index idx) const noexcept override
+  {
+    return get_move(get_base_solution().size(), idx);
+  }
+
+  [[nodiscard]] fai::Index index_of(Move const& move) const noexcept override
+  {
+    return get_move_index(get_base_solution().size(), move);
+  }
+
+  static constexpr fai::Index get_size(fai::Index nb_tasks) noexcept
+  {
+    return std::max(nb_tasks - 1, 0);
+  }
+
+  static constexpr Move get_move([[maybe_unused]] fai::Index nb_tasks,
+                                 fai::Index                  idx) noexcept
+  {
+    return Move::swap(idx);
+  }
+
+  static constexpr fai::Index get_move_index([[maybe_unused]] fai::Index nb_tasks,
+                                             Move const&                 move) noexcept
+  {
+    return move.beg;
   }
 };
 
@@ -304,160 +523,163 @@ public:
   using Neighborhood_base::Neighborhood_base;
 
 private:
-  class Iterator_derived : public Polymorphic_iterator
+  class Cursor
   {
   private:
-    Scheduling solution;
+    fai::Index nb_tasks;
     fai::Index modif_pos_beg{0};
     fai::Index modif_pos_end{modif_pos_beg + 2};
+    // updated when the reversed range grows while advancing
+    mutable Reversed_block_evaluation block_eval;
 
   public:
-    Iterator_derived(Scheduling const& base_sol) : solution(base_sol)
-    {
-      std::reverse(std::next(solution.begin(), modif_pos_beg),
-                   std::next(solution.begin(), modif_pos_end));
-    }
+    explicit Cursor(fai::Index nb_tasks) : nb_tasks(nb_tasks) {}
 
-    Iterator_derived(Scheduling const& base_sol, Reverse_tag)
-      : solution(base_sol), modif_pos_beg(base_sol.size() - 2)
+    Cursor(fai::Index nb_tasks, Reverse_tag)
+      : nb_tasks(nb_tasks), modif_pos_beg(nb_tasks - 2)
     {
-      std::reverse(std::next(solution.begin(), modif_pos_beg),
-                   std::next(solution.begin(), modif_pos_end));
     }
 
-    void advance() override
+    void advance()
     {
-      next_range();
-      if (!is_fend())
+      ++modif_pos_end;
+      if (modif_pos_end == nb_tasks + 1)
       {
-        inc_reversed_range();
+        ++modif_pos_beg;
+        modif_pos_end = modif_pos_beg + 2;
       }
     }
 
-    void move_by(int dist) override
+    void move_by(int dist)
     {
-      if (dist == 0)
+      fai::Index idx = get_index() + dist;
+      if (idx < 0)
       {
-        return;
+        // rend
+        modif_pos_beg = -1;
+        modif_pos_end = nb_tasks;
       }
-      // restore
-      reverse_range();
-      if (dist > 0)
+      else if (idx >= get_size(nb_tasks))
       {
-        for (int i = 0; i < dist; ++i)
-        {
-          ++modif_pos_end;
-          if (modif_pos_end == solution.size() + 1)
-          {
-            ++modif_pos_beg;
-            modif_pos_end = modif_pos_beg + 2;
-          }
-        }
+        // fend
+        modif_pos_beg = nb_tasks - 1;
+        modif_pos_end = nb_tasks + 1;
       }
       else
       {
-        for (int i = 0; i < -dist; ++i)
-        {
-          --modif_pos_end;
-          if (modif_pos_end == modif_pos_beg + 1)
-          {
-            --modif_pos_beg;
-            modif_pos_end = solution.size();
-          }
-        }
+        Move move = get_move(nb_tasks, idx);
+        modif_pos_beg = move.beg;
+        modif_pos_end = move.end;
       }
-      reverse_range();
     }
 
-    void go_back() override
+    void go_back()
     {
       --modif_pos_end;
       if (modif_pos_end == modif_pos_beg + 1)
       {
-        // restore
-        std::swap(solution[modif_pos_beg], solution[modif_pos_beg + 1]);
         --modif_pos_beg;
-        modif_pos_end = solution.size();
-        if (!is_rend())
-        {
-          // reverse all in subrange
-          reverse_range();
-        }
-      }
-      else
-      {
-        // rotate left
-        auto beg = std::next(std::begin(solution), modif_pos_beg);
-        std::rotate(beg, beg + 1, std::next(std::begin(solution), modif_pos_end + 1));
+        modif_pos_end = nb_tasks;
       }
     }
 
-    Scheduling const& get_current_neighbor() const noexcept override
-    {
-      return solution;
-    }
-
-    [[nodiscard]] bool is_fend() const noexcept override
+    [[nodiscard]] Move get_current_move() const noexcept
     {
-      return modif_pos_beg >= solution.size() - 1;
+      return Move::reverse(modif_pos_beg, modif_pos_end);
     }
 
-    [[nodiscard]] bool is_rend() const noexcept override
+    [[nodiscard]] fai::Cost get_current_cost(
+      Prefix_evaluation const& base_eval) const
     {
-      return modif_pos_beg < 0;
+      return block_eval.get_neighbor_cost(base_eval, modif_pos_beg, modif_pos_end);
     }
 
-  private:
-    void next_range() noexcept
+    [[nodiscard]] fai::Index get_index() const noexcept
     {
-      ++modif_pos_end;
-      if (modif_pos_end == solution.size() + 1)
+      if (is_rend())
       {
-        --modif_pos_end;
-        reverse_range();
-
-        ++modif_pos_beg;
-        modif_pos_end = modif_pos_beg + 2;
+        return -1;
       }
+      if (is_fend())
+      {
+        return get_size(nb_tasks);
+      }
+      return get_move_index(nb_tasks, get_current_move());
     }
 
-    void inc_reversed_range()
+    [[nodiscard]] bool is_fend() const noexcept
     {
-      // rotate right
-      auto rbegin =
-        std::make_reverse_iterator(std::next(std::begin(solution), modif_pos_end));
-      std::rotate(rbegin, rbegin + 1, std::prev(std::rend(solution), modif_pos_beg));
+      return modif_pos_beg >= nb_tasks - 1;
     }
 
-    void reverse_range()
+    [[nodiscard]] bool is_rend() const noexcept
     {
-      std::reverse(std::next(std::begin(solution), modif_pos_beg),
-                   std::next(std::begin(solution), modif_pos_end));
+      return modif_pos_beg < 0;
     }
   };
 
 public:
   Iterator begin() noexcept override
   {
-    return Iterator(std::make_unique<Iterator_derived>(get_base_solution()));
+    return Iterator(
+      std::make_unique<Polymorphic_cursor<Cursor>>(get_base_solution().size()));
   }
 
   Iterator rbegin() noexcept override
   {
-    return Iterator(std::make_unique<Polymorphic_reverse_iterator<Iterator_derived>>(
-      get_base_solution(),
-      Iterator_derived::reverse_tag));
+    return Iterator(
+      std::make_unique<Polymorphic_reverse_iterator<Polymorphic_cursor<Cursor>>>(
+        get_base_solution().size(),
+        reverse_tag));
+  }
+
+  Static_iterator<Cursor> static_begin() const noexcept
+  {
+    return Static_iterator<Cursor>(Cursor(get_base_solution().size()));
   }
 
-  // Iterator end()
-  // {
-  //   return Iterator(base_solution.size() - 1);
-  // }
+  Static_iterator<Cursor, true> static_rbegin() const noexcept
+  {
+    return Static_iterator<Cursor, true>(
+      Cursor(get_base_solution().size(), reverse_tag));
+  }
 
   fai::Index size() const noexcept override
   {
-    fai::Index n = get_base_solution().size();
-    return n * (n - 1) / 2;
+    return get_size(get_base_solution().size());
+  }
+
+  [[nodiscard]] Move at(fai::Index idx) const noexcept override
+  {
+    return get_move(get_base_solution().size(), idx);
+  }
+
+  [[nodiscard]] fai::Index index_of(Move const& move) const noexcept override
+  {
+    return get_move_index(get_base_solution().size(), move);
+  }
+
+  static constexpr fai::Index get_size(fai::Index nb_tasks) noexcept
+  {
+    return nb_tasks * (nb_tasks - 1) / 2;
+  }
+
+  /**
+   * @brief the moves of the block beginning at beg are grouped: group beg has
+   * nb_tasks - 1 - beg moves
+   */
+  static Move get_move(fai::Index nb_tasks, fai::Index idx) noexcept
+  {
+    fai::Index beg = triangular_group(nb_tasks - 1, idx);
+    auto       offset = static_cast<fai::Index>(triangular_offset(nb_tasks - 1, beg));
+    return Move::reverse(beg, beg + 2 + idx - offset);
+  }
+
+  static constexpr fai::Index get_move_index(fai::Index  nb_tasks,
+                                             Move const& move) noexcept
+  {
+    return static_cast<fai::Index>(triangular_offset(nb_tasks - 1, move.beg)) +
+           move.end - move.beg - 2;
   }
 };
 
@@ -486,128 +708,96 @@ public:
   }
 
 private:
-  class Iterator_derived : public Polymorphic_iterator
+  class Cursor
   {
   private:
-    Scheduling solution;
+    fai::Index nb_tasks;
     fai::Index modif_pos_beg{0};
     fai::Index modif_pos_end{modif_pos_beg + 2};
 
   public:
-    Iterator_derived(Scheduling const& base_sol) : solution(base_sol)
-    {
-      std::reverse(std::next(solution.begin(), modif_pos_beg),
-                   std::next(solution.begin(), modif_pos_end));
-    }
+    explicit Cursor(fai::Index nb_tasks) : nb_tasks(nb_tasks) {}
 
-    Iterator_derived(Scheduling const& base_sol, Reverse_tag)
-      : solution(base_sol),
-        modif_pos_beg(base_sol.size() - std::min(base_sol.size(), max_range_size)),
-        modif_pos_end(base_sol.size())
+    Cursor(fai::Index nb_tasks, Reverse_tag)
+      : nb_tasks(nb_tasks),
+        modif_pos_beg(nb_tasks - std::min(nb_tasks, max_range_size)),
+        modif_pos_end(nb_tasks)
     {
-      std::reverse(std::next(solution.begin(), modif_pos_beg),
-                   std::next(solution.begin(), modif_pos_end));
     }
 
-    void advance() override
+    void advance()
     {
       ++modif_pos_beg;
       ++modif_pos_end;
-      if (modif_pos_end == solution.size() + 1)
+      if (modif_pos_end == nb_tasks + 1)
       {
-        --modif_pos_beg;
-        --modif_pos_end;
-        reverse_range();
-
         set_subrange<1>();
-        if (!is_fend())
-        {
-          reverse_range();
-        }
-      }
-      else if (!is_fend())
-      {
-        // rotate right
-        auto rbegin =
-          std::make_reverse_iterator(std::next(std::begin(solution), modif_pos_end));
-        std::rotate(rbegin,
-                    rbegin + 2,
-                    std::prev(std::rend(solution), modif_pos_beg - 1));
       }
     }
 
-    void move_by(int dist) override
+    void move_by(int dist)
     {
-      if (dist == 0)
+      fai::Index idx = get_index() + dist;
+      if (idx < 0)
       {
-        return;
+        // rend
+        modif_pos_beg = nb_tasks - 1;
+        modif_pos_end = nb_tasks;
       }
-      // restore
-      reverse_range();
-      if (dist > 0)
+      else if (idx >= get_size(nb_tasks))
       {
-        for (int i = 0; i < dist; ++i)
-        {
-          ++modif_pos_beg;
-          ++modif_pos_end;
-          if (modif_pos_end == solution.size() + 1)
-          {
-            set_subrange<1>();
-          }
-        }
+        // fend
+        modif_pos_beg = 0;
+        modif_pos_end = std::min(nb_tasks, max_range_size) + 1;
       }
       else
       {
-        for (int i = 0; i < -dist; ++i)
-        {
-          --modif_pos_end;
-          --modif_pos_beg;
-          if (modif_pos_beg == -1)
-          {
-            set_subrange<-1>();
-          }
-        }
+        Move move = get_move(nb_tasks, idx);
+        modif_pos_beg = move.beg;
+        modif_pos_end = move.end;
       }
-      reverse_range();
     }
 
-    void go_back() override
+    void go_back()
     {
       --modif_pos_beg;
       --modif_pos_end;
       if (modif_pos_beg == -1)
       {
-        // restore
-        ++modif_pos_beg;
-        ++modif_pos_end;
-        reverse_range();
-
         set_subrange<-1>();
-        if (!is_rend())
-        {
-          // reverse all in subrange
-          reverse_range();
-        }
-      }
-      else
-      {
-        // rotate left
-        auto beg = std::next(std::begin(solution), modif_pos_beg);
-        std::rotate(beg, beg + 2, std::next(std::begin(solution), modif_pos_end + 1));
       }
     }
 
-    Scheduling const& get_current_neighbor() const noexcept override
+    [[nodiscard]] Move get_current_move() const noexcept
     {
-      return solution;
+      return Move::reverse(modif_pos_beg, modif_pos_end);
     }
 
-    [[nodiscard]] bool is_fend() const noexcept override
+    [[nodiscard]] fai::Cost get_current_cost(Prefix_evaluation const& base_eval) const
     {
-      return subrange_size() > std::min(solution.size(), max_range_size);
+      // the range slides instead of growing, evaluate it: O(max_range_size)
+      return base_eval.get_neighbor_cost(get_current_move());
     }
 
-    [[nodiscard]] bool is_rend() const noexcept override
+    [[nodiscard]] fai::Index get_index() const noexcept
+    {
+      if (is_rend())
+      {
+        return -1;
+      }
+      if (is_fend())
+      {
+        return get_size(nb_tasks);
+      }
+      return get_move_index(nb_tasks, get_current_move());
+    }
+
+    [[nodiscard]] bool is_fend() const noexcept
+    {
+      return subrange_size() > std::min(nb_tasks, max_range_size);
+    }
+
+    [[nodiscard]] bool is_rend() const noexcept
     {
       return subrange_size() < 2;
     }
@@ -629,65 +819,981 @@ private:
       }
       else
       {
-        modif_pos_end = solution.size();
-        modif_pos_beg = solution.size() - subrng_sz - rel_sz;
+        modif_pos_end = nb_tasks;
+        modif_pos_beg = nb_tasks - subrng_sz - rel_sz;
       }
     }
-
-    void reverse_range()
-    {
-      std::reverse(std::next(std::begin(solution), modif_pos_beg),
-                   std::next(std::begin(solution), modif_pos_end));
-    }
   };
 
 public:
   Iterator begin() noexcept override
   {
-    return Iterator(std::make_unique<Iterator_derived>(get_base_solution()));
+    return Iterator(
+      std::make_unique<Polymorphic_cursor<Cursor>>(get_base_solution().size()));
   }
 
   Iterator rbegin() noexcept override
   {
-    return Iterator(std::make_unique<Polymorphic_reverse_iterator<Iterator_derived>>(
-      get_base_solution(),
-      Iterator_derived::reverse_tag));
+    return Iterator(
+      std::make_unique<Polymorphic_reverse_iterator<Polymorphic_cursor<Cursor>>>(
+        get_base_solution().size(),
+        reverse_tag));
   }
 
-  // Iterator end()
-  // {
-  //   return Iterator(base_solution.size() - 1);
-  // }
-
-  fai::Index size() const noexcept override
+  Static_iterator<Cursor> static_begin() const noexcept
   {
-    fai::Index n = get_base_solution().size();
-    fai::Index k = max_range_size;
-    return (n * (n - 1) - (n - k) * (n - k + 1)) / 2;
+    return Static_iterator<Cursor>(Cursor(get_base_solution().size()));
   }
-};
-
-template <typename Neighborhood>
-class Backward_neighborhood : public Neighborhood_abstract
-{
-private:
-  Neighborhood nbh;
-
-public:
-  using Base_neighborhood = Neighborhood;
 
-  explicit Backward_neighborhood(Scheduling base_solution) : nbh(std::move(base_solution))
+  Static_iterator<Cursor, true> static_rbegin() const noexcept
   {
+    return Static_iterator<Cursor, true>(
+      Cursor(get_base_solution().size(), reverse_tag));
   }
 
-  Iterator begin() noexcept override
+  fai::Index size() const noexcept override
   {
-    return std::rbegin(nbh);
+    return get_size(get_base_solution().size());
   }
 
-  Iterator rbegin() noexcept override
+  [[nodiscard]] Move at(fai::Index idx) const noexcept override
   {
-    return std::begin(nbh);
+    return get_move(get_base_solution().size(), idx);
+  }
+
+  [[nodiscard]] fai::Index index_of(Move const& move) const noexcept override
+  {
+    return get_move_index(get_base_solution().size(), move);
+  }
+
+  static constexpr fai::Index get_size(fai::Index nb_tasks) noexcept
+  {
+    fai::Index n = nb_tasks;
+    fai::Index k = std::min(nb_tasks, max_range_size);
+    return (n * (n - 1) - (n - k) * (n - k + 1)) / 2;
+  }
+
+  /**
+   * @brief the moves are grouped by block size: group j has the nb_tasks - 1 - j blocks
+   * of size j + 2
+   */
+  static Move get_move(fai::Index nb_tasks, fai::Index idx) noexcept
+  {
+    fai::Index j = triangular_group(nb_tasks - 1, idx);
+    auto       beg = idx - static_cast<fai::Index>(triangular_offset(nb_tasks - 1, j));
+    return Move::reverse(beg, beg + j + 2);
+  }
+
+  static constexpr fai::Index get_move_index(fai::Index  nb_tasks,
+                                             Move const& move) noexcept
+  {
+    fai::Index j = move.end - move.beg - 2;
+    return static_cast<fai::Index>(triangular_offset(nb_tasks - 1, j)) + move.beg;
+  }
+};
+
+/**
+ * @brief insertion of a task at another position, at most max_distance positions away
+ *
+ * for each task, it is first moved forward one position at a time, then backward one
+ * position at a time from 2 positions before (moving it just before is the same move as
+ * moving the previous task just after it), so that each step only shifts one more task
+ * and is evaluated in O(1)
+ *
+ * 1|2|3|4|5|6
+ *   \___
+ *       v
+ * 1|3|4|2|5|6
+ */
+template <fai::Index max_distance>
+class Bounded_insertion_neighborhood : public Neighborhood_base
+{
+public:
+  using Neighborhood_base::Neighborhood_base;
+
+  static constexpr fai::Index get_max_distance() noexcept
+  {
+    return max_distance;
+  }
+
+private:
+  class Cursor
+  {
+  private:
+    fai::Index nb_tasks;
+    fai::Index from{-1};
+    fai::Index to{0};
+    mutable Block_move_evaluation insertion_eval;
+
+  public:
+    explicit Cursor(fai::Index nb_tasks) : nb_tasks(nb_tasks)
+    {
+      next_task();
+    }
+
+    Cursor(fai::Index nb_tasks, Reverse_tag) : nb_tasks(nb_tasks)
+    {
+      move_by(get_size(nb_tasks));
+    }
+
+    void advance()
+    {
+      if (is_rend())
+      {
+        next_task();
+      }
+      else if (to > from && to < from + get_forward_count(nb_tasks, from))
+      {
+        ++to;
+      }
+      else if (to > from && get_backward_count(from) > 0)
+      {
+        to = from - 2;
+      }
+      else if (to < from && to > from - 1 - get_backward_count(from))
+      {
+        --to;
+      }
+      else
+      {
+        next_task();
+      }
+    }
+
+    void move_by(int dist)
+    {
+      fai::Index idx = get_index() + dist;
+      if (idx < 0)
+      {
+        // rend
+        from = -1;
+        to = 0;
+      }
+      else if (idx >= get_size(nb_tasks))
+      {
+        // fend
+        from = nb_tasks;
+        to = nb_tasks + 1;
+      }
+      else
+      {
+        std::tie(from, to) = get_insertion(nb_tasks, idx);
+      }
+    }
+
+    void go_back()
+    {
+      move_by(-1);
+    }
+
+    [[nodiscard]] Move get_current_move() const noexcept
+    {
+      return Move::insertion(from, to);
+    }
+
+    [[nodiscard]] fai::Cost get_current_cost(Prefix_evaluation const& base_eval) const
+    {
+      // one more shifted task than the previous move: O(1)
+      return insertion_eval.get_neighbor_cost(base_eval, from, 1, to);
+    }
+
+    [[nodiscard]] fai::Index get_index() const noexcept
+    {
+      if (is_rend())
+      {
+        return -1;
+      }
+      if (is_fend())
+      {
+        return get_size(nb_tasks);
+      }
+      return get_insertion_index(nb_tasks, from, to);
+    }
+
+    [[nodiscard]] bool is_fend() const noexcept
+    {
+      return from >= nb_tasks;
+    }
+
+    [[nodiscard]] bool is_rend() const noexcept
+    {
+      return from < 0;
+    }
+
+  private:
+    void next_task() noexcept
+    {
+      for (++from; from < nb_tasks; ++from)
+      {
+        if (get_forward_count(nb_tasks, from) > 0)
+        {
+          to = from + 1;
+          return;
+        }
+        if (get_backward_count(from) > 0)
+        {
+          to = from - 2;
+          return;
+        }
+      }
+      to = nb_tasks + 1;
+    }
+  };
+
+public:
+  Iterator begin() noexcept override
+  {
+    return Iterator(
+      std::make_unique<Polymorphic_cursor<Cursor>>(get_base_solution().size()));
+  }
+
+  Iterator rbegin() noexcept override
+  {
+    return Iterator(
+      std::make_unique<Polymorphic_reverse_iterator<Polymorphic_cursor<Cursor>>>(
+        get_base_solution().size(),
+        reverse_tag));
+  }
+
+  Static_iterator<Cursor> static_begin() const noexcept
+  {
+    return Static_iterator<Cursor>(Cursor(get_base_solution().size()));
+  }
+
+  Static_iterator<Cursor, true> static_rbegin() const noexcept
+  {
+    return Static_iterator<Cursor, true>(
+      Cursor(get_base_solution().size(), reverse_tag));
+  }
+
+  fai::Index size() const noexcept override
+  {
+    return get_size(get_base_solution().size());
+  }
+
+  [[nodiscard]] Move at(fai::Index idx) const noexcept override
+  {
+    return get_move(get_base_solution().size(), idx);
+  }
+
+  [[nodiscard]] fai::Index index_of(Move const& move) const noexcept override
+  {
+    return get_move_index(get_base_solution().size(), move);
+  }
+
+  static constexpr fai::Index get_size(fai::Index nb_tasks) noexcept
+  {
+    return static_cast<fai::Index>(get_offset(nb_tasks, std::max(nb_tasks, 0)));
+  }
+
+  static Move get_move(fai::Index nb_tasks, fai::Index idx) noexcept
+  {
+    auto [from, to] = get_insertion(nb_tasks, idx);
+    return Move::insertion(from, to);
+  }
+
+  static constexpr fai::Index get_move_index(fai::Index  nb_tasks,
+                                             Move const& move) noexcept
+  {
+    if (move.middle == move.beg + 1)
+    {
+      // forward, also the backward insertion of the next task just before
+      return get_insertion_index(nb_tasks, move.beg, move.end - 1);
+    }
+    return get_insertion_index(nb_tasks, move.middle, move.beg);
+  }
+
+private:
+  static constexpr fai::Index get_forward_count(fai::Index nb_tasks,
+                                                fai::Index from) noexcept
+  {
+    return std::min(max_distance, nb_tasks - 1 - from);
+  }
+
+  static constexpr fai::Index get_backward_count(fai::Index from) noexcept
+  {
+    return std::max(std::min(max_distance, from) - 1, 0);
+  }
+
+  /**
+   * @brief number of moves of the tasks before from
+   */
+  static constexpr std::int64_t get_offset(fai::Index nb_tasks, fai::Index from) noexcept
+  {
+    std::int64_t forward = bounded_triangular_sum(max_distance, nb_tasks) -
+                           bounded_triangular_sum(max_distance, nb_tasks - from);
+    std::int64_t backward =
+      bounded_triangular_sum(max_distance, from) - std::max(from - 1, 0);
+    return forward + backward;
+  }
+
+  static constexpr fai::Index get_insertion_index(fai::Index nb_tasks,
+                                                  fai::Index from,
+                                                  fai::Index to) noexcept
+  {
+    auto offset = static_cast<fai::Index>(get_offset(nb_tasks, from));
+    if (to > from)
+    {
+      return offset + to - from - 1;
+    }
+    return offset + get_forward_count(nb_tasks, from) + from - 2 - to;
+  }
+
+  /**
+   * @brief from and to of the idx-th move
+   *
+   * all the tasks have nb_tasks - 2 moves but the first one when the distance is not
+   * bounded, and 2 * max_distance - 1 but the max_distance first and last ones when it
+   * is: O(1), otherwise binary search of the task: O(log(nb_tasks))
+   */
+  static std::pair<fai::Index, fai::Index> get_insertion(fai::Index nb_tasks,
+                                                         fai::Index idx) noexcept
+  {
+    fai::Index from = 0;
+    if (max_distance >= nb_tasks - 1)
+    {
+      from = idx < nb_tasks - 1 ? 0 : 1 + (idx - nb_tasks + 1) / (nb_tasks - 2);
+    }
+    else if (std::int64_t middle_rank = idx - get_offset(nb_tasks, max_distance),
+             nb_middle_moves = 2 * std::int64_t{max_distance} - 1;
+             middle_rank >= 0 &&
+             middle_rank < (nb_tasks - 2 * std::int64_t{max_distance}) * nb_middle_moves)
+    {
+      // the tasks in [max_distance, nb_tasks - max_distance)
+      from = max_distance + static_cast<fai::Index>(middle_rank / nb_middle_moves);
+    }
+    else
+    {
+      fai::Index last = nb_tasks - 1;
+      while (from < last)
+      {
+        fai::Index mid = from + (last - from + 1) / 2;
+        if (get_offset(nb_tasks, mid) <= idx)
+        {
+          from = mid;
+        }
+        else
+        {
+          last = mid - 1;
+        }
+      }
+    }
+
+    auto       rank = idx - static_cast<fai::Index>(get_offset(nb_tasks, from));
+    fai::Index forward_count = get_forward_count(nb_tasks, from);
+    if (rank < forward_count)
+    {
+      return {from, from + 1 + rank};
+    }
+    return {from, from - 2 - (rank - forward_count)};
+  }
+};
+
+/**
+ * @brief insertion of a task at any other position
+ */
+class Insertion_neighborhood
+  : public Bounded_insertion_neighborhood<std::numeric_limits<fai::Index>::max()>
+{
+public:
+  using Bounded_insertion_neighborhood::Bounded_insertion_neighborhood;
+};
+
+/**
+ * @brief move of a block of 1 to max_block_size tasks at another position, keeping the
+ * order of its tasks (or-opt)
+ *
+ * the moves are grouped by block size, then by block position, the block is moved forward
+ * one position at a time, then backward one position at a time, so that each step only
+ * shifts one more task and is evaluated in O(block size)
+ *
+ * moving a block backward by at most max_block_size positions is the same move as moving
+ * the tasks it passes forward, those moves are skipped
+ *
+ * 1|2|3|4|5|6
+ *   \_/___
+ *         v
+ * 1|4|5|2|3|6
+ */
+template <fai::Index max_block_size>
+class Block_move_neighborhood : public Neighborhood_base
+{
+public:
+  using Neighborhood_base::Neighborhood_base;
+
+  static constexpr fai::Index get_max_block_size() noexcept
+  {
+    return max_block_size;
+  }
+
+private:
+  class Cursor
+  {
+  private:
+    fai::Index nb_tasks;
+    fai::Index len{1};
+    fai::Index from{-1};
+    fai::Index to{0};
+    mutable Block_move_evaluation block_eval;
+
+  public:
+    explicit Cursor(fai::Index nb_tasks) : nb_tasks(nb_tasks)
+    {
+      next_block();
+    }
+
+    Cursor(fai::Index nb_tasks, Reverse_tag) : nb_tasks(nb_tasks), len(0)
+    {
+      move_by(get_size(nb_tasks));
+    }
+
+    void advance()
+    {
+      if (is_rend())
+      {
+        len = 1;
+        from = -1;
+        next_block();
+      }
+      else if (to > from && to < nb_tasks - len)
+      {
+        ++to;
+      }
+      else if (to > from && from > max_block_size)
+      {
+        to = from - max_block_size - 1;
+      }
+      else if (to < from && to > 0)
+      {
+        --to;
+      }
+      else
+      {
+        next_block();
+      }
+    }
+
+    void move_by(int dist)
+    {
+      fai::Index idx = get_index() + dist;
+      if (idx < 0)
+      {
+        // rend
+        len = 0;
+      }
+      else if (idx >= get_size(nb_tasks))
+      {
+        // fend
+        len = get_max_len(nb_tasks) + 1;
+      }
+      else
+      {
+        std::tie(from, len, to) = get_block_move(nb_tasks, idx);
+      }
+    }
+
+    void go_back()
+    {
+      move_by(-1);
+    }
+
+    [[nodiscard]] Move get_current_move() const noexcept
+    {
+      return Move::block_move(from, len, to);
+    }
+
+    [[nodiscard]] fai::Cost get_current_cost(Prefix_evaluation const& base_eval) const
+    {
+      // one more shifted task than the previous move: O(len)
+      return block_eval.get_neighbor_cost(base_eval, from, len, to);
+    }
+
+    [[nodiscard]] fai::Index get_index() const noexcept
+    {
+      if (is_rend())
+      {
+        return -1;
+      }
+      if (is_fend())
+      {
+        return get_size(nb_tasks);
+      }
+      return get_block_move_index(nb_tasks, from, len, to);
+    }
+
+    [[nodiscard]] bool is_fend() const noexcept
+    {
+      return len > get_max_len(nb_tasks);
+    }
+
+    [[nodiscard]] bool is_rend() const noexcept
+    {
+      return len < 1;
+    }
+
+  private:
+    void next_block() noexcept
+    {
+      for (++from; len <= get_max_len(nb_tasks); ++from)
+      {
+        if (from > nb_tasks - len)
+        {
+          ++len;
+          from = -1;
+        }
+        else if (from + len < nb_tasks)
+        {
+          to = from + 1;
+          return;
+        }
+        else if (from > max_block_size)
+        {
+          to = from - max_block_size - 1;
+          return;
+        }
+      }
+    }
+  };
+
+public:
+  Iterator begin() noexcept override
+  {
+    return Iterator(
+      std::make_unique<Polymorphic_cursor<Cursor>>(get_base_solution().size()));
+  }
+
+  Iterator rbegin() noexcept override
+  {
+    return Iterator(
+      std::make_unique<Polymorphic_reverse_iterator<Polymorphic_cursor<Cursor>>>(
+        get_base_solution().size(),
+        reverse_tag));
+  }
+
+  Static_iterator<Cursor> static_begin() const noexcept
+  {
+    return Static_iterator<Cursor>(Cursor(get_base_solution().size()));
+  }
+
+  Static_iterator<Cursor, true> static_rbegin() const noexcept
+  {
+    return Static_iterator<Cursor, true>(
+      Cursor(get_base_solution().size(), reverse_tag));
+  }
+
+  fai::Index size() const noexcept override
+  {
+    return get_size(get_base_solution().size());
+  }
+
+  [[nodiscard]] Move at(fai::Index idx) const noexcept override
+  {
+    return get_move(get_base_solution().size(), idx);
+  }
+
+  [[nodiscard]] fai::Index index_of(Move const& move) const noexcept override
+  {
+    return get_move_index(get_base_solution().size(), move);
+  }
+
+  static constexpr fai::Index get_size(fai::Index nb_tasks) noexcept
+  {
+    return static_cast<fai::Index>(get_group_offset(nb_tasks, get_max_len(nb_tasks) + 1));
+  }
+
+  static Move get_move(fai::Index nb_tasks, fai::Index idx) noexcept
+  {
+    auto [from, len, to] = get_block_move(nb_tasks, idx);
+    return Move::block_move(from, len, to);
+  }
+
+  static constexpr fai::Index get_move_index(fai::Index  nb_tasks,
+                                             Move const& move) noexcept
+  {
+    fai::Index forward_len = move.middle - move.beg;
+    if (forward_len <= max_block_size)
+    {
+      return get_block_move_index(nb_tasks,
+                                  move.beg,
+                                  forward_len,
+                                  move.end - forward_len);
+    }
+    return get_block_move_index(nb_tasks, move.middle, move.end - move.middle, move.beg);
+  }
+
+private:
+  static constexpr fai::Index get_max_len(fai::Index nb_tasks) noexcept
+  {
+    return std::min(max_block_size, nb_tasks - 1);
+  }
+
+  /**
+   * @brief number of moves of the blocks of size len starting before x
+   *
+   * the block at from has nb_tasks - len - from forward moves and
+   * from - max_block_size backward moves
+   */
+  static constexpr std::int64_t get_block_offset(fai::Index nb_tasks,
+                                                 fai::Index len,
+                                                 fai::Index x) noexcept
+  {
+    std::int64_t forward =
+      std::int64_t{x} * (nb_tasks - len) - std::int64_t{x} * (x - 1) / 2;
+    std::int64_t t = std::max(x - 1 - max_block_size, 0);
+    return forward + t * (t + 1) / 2;
+  }
+
+  /**
+   * @brief number of moves of the blocks smaller than len: O(max_block_size)
+   */
+  static constexpr std::int64_t get_group_offset(fai::Index nb_tasks,
+                                                 fai::Index len) noexcept
+  {
+    std::int64_t offset = 0;
+    for (fai::Index l = 1; l < len; ++l)
+    {
+      offset += get_block_offset(nb_tasks, l, nb_tasks - l + 1);
+    }
+    return offset;
+  }
+
+  static constexpr fai::Index get_block_move_index(fai::Index nb_tasks,
+                                                   fai::Index from,
+                                                   fai::Index len,
+                                                   fai::Index to) noexcept
+  {
+    auto offset = static_cast<fai::Index>(get_group_offset(nb_tasks, len) +
+                                          get_block_offset(nb_tasks, len, from));
+    if (to > from)
+    {
+      return offset + to - from - 1;
+    }
+    return offset + nb_tasks - len - from + from - max_block_size - 1 - to;
+  }
+
+  /**
+   * @brief from, len and to of the idx-th move
+   *
+   * linear search of the block size, then binary search of the block position:
+   * O(max_block_size + log(nb_tasks))
+   */
+  static std::tuple<fai::Index, fai::Index, fai::Index>
+  get_block_move(fai::Index nb_tasks, fai::Index idx) noexcept
+  {
+    fai::Index len = 1;
+    auto       rank = static_cast<std::int64_t>(idx);
+    for (std::int64_t group_size = get_block_offset(nb_tasks, len, nb_tasks - len + 1);
+         rank >= group_size;
+         group_size = get_block_offset(nb_tasks, len, nb_tasks - len + 1))
+    {
+      rank -= group_size;
+      ++len;
+    }
+
+    fai::Index from = 0;
+    fai::Index last = nb_tasks - len;
+    while (from < last)
+    {
+      fai::Index mid = from + (last - from + 1) / 2;
+      if (get_block_offset(nb_tasks, len, mid) <= rank)
+      {
+        from = mid;
+      }
+      else
+      {
+        last = mid - 1;
+      }
+    }
+
+    rank -= get_block_offset(nb_tasks, len, from);
+    auto       move_rank = static_cast<fai::Index>(rank);
+    fai::Index forward_count = nb_tasks - len - from;
+    if (move_rank < forward_count)
+    {
+      return {from, len, from + 1 + move_rank};
+    }
+    return {from, len, from - max_block_size - 1 - (move_rank - forward_count)};
+  }
+};
+
+/**
+ * @brief swap of 2 tasks at most max_distance positions away
+ *
+ * for each first task, the second one goes from the next task to the farthest one, the
+ * tasks in between are shifted by the difference of their execution times, only the
+ * ones whose slack or lateness is smaller than that shift are evaluated
+ *
+ * 1|2|3|4|5|6
+ *   \___/
+ *     X
+ *   /   \
+ * 1|4|3|2|5|6
+ */
+template <fai::Index max_distance>
+class Bounded_swap_neighborhood : public Neighborhood_base
+{
+public:
+  using Neighborhood_base::Neighborhood_base;
+
+  static constexpr fai::Index get_max_distance() noexcept
+  {
+    return max_distance;
+  }
+
+private:
+  class Cursor
+  {
+  private:
+    fai::Index nb_tasks;
+    fai::Index first{0};
+    fai::Index second{1};
+
+  public:
+    explicit Cursor(fai::Index nb_tasks) : nb_tasks(nb_tasks) {}
+
+    Cursor(fai::Index nb_tasks, Reverse_tag)
+      : nb_tasks(nb_tasks), first(nb_tasks - 2), second(nb_tasks - 1)
+    {
+    }
+
+    void advance()
+    {
+      if (is_rend() || second - first >= get_forward_count(nb_tasks, first))
+      {
+        ++first;
+        second = first;
+      }
+      ++second;
+    }
+
+    void move_by(int dist)
+    {
+      fai::Index idx = get_index() + dist;
+      if (idx < 0)
+      {
+        // rend
+        first = -1;
+        second = 0;
+      }
+      else if (idx >= get_size(nb_tasks))
+      {
+        // fend
+        first = std::max(nb_tasks - 1, 0);
+        second = first + 1;
+      }
+      else
+      {
+        std::tie(first, second) = get_swap(nb_tasks, idx);
+      }
+    }
+
+    void go_back()
+    {
+      --second;
+      if (second == first)
+      {
+        --first;
+        second = first + std::max(get_forward_count(nb_tasks, first), 1);
+      }
+    }
+
+    [[nodiscard]] Move get_current_move() const noexcept
+    {
+      return Move::swap(first, second);
+    }
+
+    [[nodiscard]] fai::Cost get_current_cost(Prefix_evaluation const& base_eval) const
+    {
+      return base_eval.get_neighbor_cost(get_current_move());
+    }
+
+    [[nodiscard]] fai::Index get_index() const noexcept
+    {
+      if (is_rend())
+      {
+        return -1;
+      }
+      if (is_fend())
+      {
+        return get_size(nb_tasks);
+      }
+      return get_swap_index(nb_tasks, first, second);
+    }
+
+    [[nodiscard]] bool is_fend() const noexcept
+    {
+      return first >= nb_tasks - 1;
+    }
+
+    [[nodiscard]] bool is_rend() const noexcept
+    {
+      return first < 0;
+    }
+  };
+
+public:
+  Iterator begin() noexcept override
+  {
+    return Iterator(
+      std::make_unique<Polymorphic_cursor<Cursor>>(get_base_solution().size()));
+  }
+
+  Iterator rbegin() noexcept override
+  {
+    return Iterator(
+      std::make_unique<Polymorphic_reverse_iterator<Polymorphic_cursor<Cursor>>>(
+        get_base_solution().size(),
+        reverse_tag));
+  }
+
+  Static_iterator<Cursor> static_begin() const noexcept
+  {
+    return Static_iterator<Cursor>(Cursor(get_base_solution().size()));
+  }
+
+  Static_iterator<Cursor, true> static_rbegin() const noexcept
+  {
+    return Static_iterator<Cursor, true>(
+      Cursor(get_base_solution().size(), reverse_tag));
+  }
+
+  fai::Index size() const noexcept override
+  {
+    return get_size(get_base_solution().size());
+  }
+
+  [[nodiscard]] Move at(fai::Index idx) const noexcept override
+  {
+    return get_move(get_base_solution().size(), idx);
+  }
+
+  [[nodiscard]] fai::Index index_of(Move const& move) const noexcept override
+  {
+    return get_move_index(get_base_solution().size(), move);
+  }
+
+  static constexpr fai::Index get_size(fai::Index nb_tasks) noexcept
+  {
+    return static_cast<fai::Index>(get_offset(nb_tasks, std::max(nb_tasks, 0)));
+  }
+
+  static Move get_move(fai::Index nb_tasks, fai::Index idx) noexcept
+  {
+    auto [first, second] = get_swap(nb_tasks, idx);
+    return Move::swap(first, second);
+  }
+
+  static constexpr fai::Index get_move_index(fai::Index  nb_tasks,
+                                             Move const& move) noexcept
+  {
+    return get_swap_index(nb_tasks, move.beg, move.end - 1);
+  }
+
+private:
+  static constexpr fai::Index get_forward_count(fai::Index nb_tasks,
+                                                fai::Index first) noexcept
+  {
+    return std::min(max_distance, nb_tasks - 1 - first);
+  }
+
+  /**
+   * @brief number of swaps whose first task is before first
+   */
+  static constexpr std::int64_t get_offset(fai::Index nb_tasks, fai::Index first) noexcept
+  {
+    return bounded_triangular_sum(max_distance, nb_tasks) -
+           bounded_triangular_sum(max_distance, nb_tasks - first);
+  }
+
+  static constexpr fai::Index get_swap_index(fai::Index nb_tasks,
+                                             fai::Index first,
+                                             fai::Index second) noexcept
+  {
+    return static_cast<fai::Index>(get_offset(nb_tasks, first)) + second - first - 1;
+  }
+
+  /**
+   * @brief positions of the idx-th swap
+   *
+   * triangular group when the distance is not bounded, the first tasks have max_distance
+   * swaps each when it is: O(1), otherwise binary search of the first task among the
+   * max_distance last ones: O(log(max_distance))
+   */
+  static std::pair<fai::Index, fai::Index> get_swap(fai::Index nb_tasks,
+                                                    fai::Index idx) noexcept
+  {
+    fai::Index first = 0;
+    if (max_distance >= nb_tasks - 1)
+    {
+      first = triangular_group(nb_tasks - 1, idx);
+    }
+    else if (idx < (nb_tasks - max_distance) * max_distance)
+    {
+      first = idx / max_distance;
+    }
+    else
+    {
+      first = nb_tasks - max_distance;
+      fai::Index last = nb_tasks - 2;
+      while (first < last)
+      {
+        fai::Index mid = first + (last - first + 1) / 2;
+        if (get_offset(nb_tasks, mid) <= idx)
+        {
+          first = mid;
+        }
+        else
+        {
+          last = mid - 1;
+        }
+      }
+    }
+    auto rank = idx - static_cast<fai::Index>(get_offset(nb_tasks, first));
+    return {first, first + 1 + rank};
+  }
+};
+
+/**
+ * @brief swap of any 2 tasks
+ */
+class Swap_neighborhood
+  : public Bounded_swap_neighborhood<std::numeric_limits<fai::Index>::max()>
+{
+public:
+  using Bounded_swap_neighborhood::Bounded_swap_neighborhood;
+};
+
+template <typename Neighborhood>
+class Backward_neighborhood : public Neighborhood_abstract
+{
+private:
+  Neighborhood nbh;
+
+public:
+  using Base_neighborhood = Neighborhood;
+
+  explicit Backward_neighborhood(Scheduling base_solution) : nbh(std::move(base_solution))
+  {
+  }
+
+  Iterator begin() noexcept override
+  {
+    return std::rbegin(nbh);
+  }
+
+  Iterator rbegin() noexcept override
+  {
+    return std::begin(nbh);
+  }
+
+  auto static_begin() const noexcept
+  {
+    return nbh.static_rbegin();
+  }
+
+  auto static_rbegin() const noexcept
+  {
+    return nbh.static_begin();
   }
 
   Scheduling& get_base_solution() noexcept override
@@ -704,6 +1810,31 @@ public:
   {
     return nbh.size();
   }
+
+  [[nodiscard]] Move at(fai::Index idx) const noexcept override
+  {
+    return get_move(get_base_solution().size(), idx);
+  }
+
+  [[nodiscard]] fai::Index index_of(Move const& move) const noexcept override
+  {
+    return get_move_index(get_base_solution().size(), move);
+  }
+
+  static constexpr fai::Index get_size(fai::Index nb_tasks) noexcept
+  {
+    return Neighborhood::get_size(nb_tasks);
+  }
+
+  static Move get_move(fai::Index nb_tasks, fai::Index idx) noexcept
+  {
+    return Neighborhood::get_move(nb_tasks, get_size(nb_tasks) - 1 - idx);
+  }
+
+  static fai::Index get_move_index(fai::Index nb_tasks, Move const& move) noexcept
+  {
+    return get_size(nb_tasks) - 1 - Neighborhood::get_move_index(nb_tasks, move);
+  }
 };
 
 template <typename U>
@@ -740,6 +1871,42 @@ public:
 template <typename U>
 using base_neighborhood_t = typename base_neighborhood<U>::type;
 
+template <typename U>
+struct Has_static_iterator
+{
+private:
+  template <typename T>
+  static constexpr auto test(T const& nbh)
+    -> decltype(nbh.static_begin(), std::true_type{});
+
+  static constexpr std::false_type test(...);
+
+public:
+  static constexpr bool value = decltype(test(std::declval<U>()))::value;
+};
+
+template <typename U>
+constexpr auto has_static_iterator_v = Has_static_iterator<U>::value;
+
+/**
+ * @brief first move of nbh, statically dispatched when the neighborhood type is concrete
+ *
+ * only a type erased Neighborhood_abstract (runtime composed neighborhoods) goes through
+ * the virtual iterator
+ */
+template <typename Neighborhood>
+auto begin_moves(Neighborhood& nbh)
+{
+  if constexpr (has_static_iterator_v<Neighborhood>)
+  {
+    return nbh.static_begin();
+  }
+  else
+  {
+    return std::begin(nbh);
+  }
+}
+
 template <typename U>
 struct Is_sliding_reverse_neighborhood
 {
@@ -774,6 +1941,58 @@ template <typename U>
 constexpr auto sliding_reverse_neighborhood_max_range_size_v =
   sliding_reverse_neighborhood_max_range_size<U>::value;
 
+template <typename U>
+struct Is_bounded_insertion_neighborhood
+{
+private:
+  template <typename T>
+  static constexpr std::false_type test(T);
+
+  template <fai::Index max_distance>
+  static constexpr std::true_type test(Bounded_insertion_neighborhood<max_distance>);
+
+public:
+  static constexpr bool value = decltype(test(std::declval<U>()))::value;
+};
+
+template <typename U>
+constexpr auto is_bounded_insertion_neighborhood_v =
+  Is_bounded_insertion_neighborhood<U>::value;
+
+template <typename U>
+struct Is_block_move_neighborhood
+{
+private:
+  template <typename T>
+  static constexpr std::false_type test(T);
+
+  template <fai::Index max_block_size>
+  static constexpr std::true_type test(Block_move_neighborhood<max_block_size>);
+
+public:
+  static constexpr bool value = decltype(test(std::declval<U>()))::value;
+};
+
+template <typename U>
+constexpr auto is_block_move_neighborhood_v = Is_block_move_neighborhood<U>::value;
+
+template <typename U>
+struct Is_bounded_swap_neighborhood
+{
+private:
+  template <typename T>
+  static constexpr std::false_type test(T);
+
+  template <fai::Index max_distance>
+  static constexpr std::true_type test(Bounded_swap_neighborhood<max_distance>);
+
+public:
+  static constexpr bool value = decltype(test(std::declval<U>()))::value;
+};
+
+template <typename U>
+constexpr auto is_bounded_swap_neighborhood_v = Is_bounded_swap_neighborhood<U>::value;
+
 template <typename Neighborhood>
 std::string get_neighborhood_name()
 {
@@ -796,6 +2015,29 @@ std::string get_neighborhood_name()
     ret += fmt::format("Sliding_reverse_neighborhood<{}>",
                        sliding_reverse_neighborhood_max_range_size_v<Base_neighborhood>);
   }
+  else if (std::is_same_v<Base_neighborhood, Insertion_neighborhood>)
+  {
+    ret += "Insertion_neighborhood";
+  }
+  else if constexpr (is_bounded_insertion_neighborhood_v<Base_neighborhood>)
+  {
+    ret += fmt::format("Bounded_insertion_neighborhood<{}>",
+                       Base_neighborhood::get_max_distance());
+  }
+  else if constexpr (is_block_move_neighborhood_v<Base_neighborhood>)
+  {
+    ret += fmt::format("Block_move_neighborhood<{}>",
+                       Base_neighborhood::get_max_block_size());
+  }
+  else if (std::is_same_v<Base_neighborhood, Swap_neighborhood>)
+  {
+    ret += "Swap_neighborhood";
+  }
+  else if constexpr (is_bounded_swap_neighborhood_v<Base_neighborhood>)
+  {
+    ret += fmt::format("Bounded_swap_neighborhood<{}>",
+                       Base_neighborhood::get_max_distance());
+  }
   else
   {
     ret += "unknown";
@@ -826,6 +2068,26 @@ std::string get_neighborhood_short_name()
     ret += fmt::format("srn{}",
                        sliding_reverse_neighborhood_max_range_size_v<Base_neighborhood>);
   }
+  else if (std::is_same_v<Base_neighborhood, Insertion_neighborhood>)
+  {
+    ret += "in";
+  }
+  else if constexpr (is_bounded_insertion_neighborhood_v<Base_neighborhood>)
+  {
+    ret += fmt::format("in{}", Base_neighborhood::get_max_distance());
+  }
+  else if constexpr (is_block_move_neighborhood_v<Base_neighborhood>)
+  {
+    ret += fmt::format("bmn{}", Base_neighborhood::get_max_block_size());
+  }
+  else if (std::is_same_v<Base_neighborhood, Swap_neighborhood>)
+  {
+    ret += "sn";
+  }
+  else if constexpr (is_bounded_swap_neighborhood_v<Base_neighborhood>)
+  {
+    ret += fmt::format("sn{}", Base_neighborhood::get_max_distance());
+  }
   else
   {
     ret += "unknown";
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Task.hpp"
+#include "move.hpp"
+#include "utils.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief task orders proven by the dominance rules of the instance
+ *
+ * Emmons' first rule, weighted (Rinnooy Kan et al.): when
+ * p_i <= p_j, w_i >= w_j and d_i <= max(d_j, p_j), a schedule where j is just before i
+ * is never better than the one where they are interchanged, so some optimal schedule has
+ * i before j. When the rule holds both ways, the task with the smallest number goes first.
+ *
+ * built once per instance: O(n^2) time, n^2 bits
+ */
+class Precedence_table
+{
+private:
+  fai::Index nb_tasks{0};
+  fai::Index nb_words{0};
+  // bit j of the row i: i precedes j
+  std::vector<std::uint64_t> rows;
+  long                       nb_precedences{0};
+
+  static bool dominates(Task const& i, Task const& j) noexcept
+  {
+    return i.exec_time <= j.exec_time && i.weight >= j.weight &&
+           i.expiry_time <= std::max(j.expiry_time, j.exec_time);
+  }
+
+public:
+  Precedence_table() = default;
+
+  explicit Precedence_table(Task_table const& tasks)
+    : nb_tasks(tasks.size()),
+      nb_words((tasks.size() + 63) / 64),
+      rows(static_cast<std::size_t>(nb_tasks) * static_cast<std::size_t>(nb_words))
+  {
+    for (fai::Index i = 0; i < nb_tasks; ++i)
+    {
+      for (fai::Index j = 0; j < nb_tasks; ++j)
+      {
+        if (i != j && dominates(tasks[i], tasks[j]) &&
+            (i < j || !dominates(tasks[j], tasks[i])))
+        {
+          get_word(i, j) |= std::uint64_t{1} << (j % 64);
+          ++nb_precedences;
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief true if the task i must be scheduled before the task j
+   */
+  [[nodiscard]] bool precedes(fai::Index i, fai::Index j) const noexcept
+  {
+    return (get_word(i, j) >> (j % 64)) & 1;
+  }
+
+  [[nodiscard]] fai::Index size() const noexcept
+  {
+    return nb_tasks;
+  }
+
+  /**
+   * @brief number of proven (i, j) orders
+   */
+  [[nodiscard]] long count() const noexcept
+  {
+    return nb_precedences;
+  }
+
+private:
+  [[nodiscard]] std::size_t get_word_index(fai::Index i, fai::Index j) const noexcept
+  {
+    return static_cast<std::size_t>(i) * static_cast<std::size_t>(nb_words) +
+           static_cast<std::size_t>(j / 64);
+  }
+
+  [[nodiscard]] std::uint64_t get_word(fai::Index i, fai::Index j) const noexcept
+  {
+    return rows[get_word_index(i, j)];
+  }
+
+  [[nodiscard]] std::uint64_t& get_word(fai::Index i, fai::Index j) noexcept
+  {
+    return rows[get_word_index(i, j)];
+  }
+};
+
+/**
+ * @brief tells in O(1) whether a move of a solution is an interchange of adjacent tasks
+ * breaking a proven task order
+ *
+ * the dominance rule only proves that some optimal schedule keeps the order, a move
+ * reversing a proven pair farther apart can still improve the solution. The interchange
+ * argument behind the rule holds for 2 adjacent tasks at any start time though: putting
+ * them out of order never lowers the cost, these moves are skipped.
+ *
+ * nothing is built, the solution is read when a move is checked
+ */
+class Precedence_filter
+{
+private:
+  Precedence_table const& precedences;
+  Scheduling const&       solution;
+
+public:
+  Precedence_filter(Precedence_table const& precedences, Scheduling const& solution)
+    : precedences(precedences), solution(solution)
+  {
+  }
+
+  /**
+   * @brief true if move only exchanges 2 adjacent tasks in a proven order
+   *
+   * the swaps, reverses and rotations of a block of 2 tasks
+   */
+  [[nodiscard]] bool breaks(Move const& move) const noexcept
+  {
+    return move.end - move.beg == 2 &&
+           precedences.precedes(solution[move.beg], solution[move.beg + 1]);
+  }
+};
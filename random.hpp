@@ -0,0 +1,96 @@
+#pragma once
+
+#include "utils.hpp"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+namespace fai
+{
+/**
+ * @brief xoshiro256++ (Blackman and Vigna): 32 bytes of state and a few cycles per draw
+ *
+ * a UniformRandomBitGenerator, the seed is spread over the state with splitmix64 so that
+ * close seeds give independent streams
+ */
+class Xoshiro256pp
+{
+private:
+  std::array<std::uint64_t, 4> state{};
+
+  static constexpr std::uint64_t rotl(std::uint64_t x, int k) noexcept
+  {
+    return (x << k) | (x >> (64 - k));
+  }
+
+public:
+  using result_type = std::uint64_t;
+
+  explicit Xoshiro256pp(std::uint64_t seed = 0) noexcept
+  {
+    for (std::uint64_t& word : state)
+    {
+      seed += 0x9e3779b97f4a7c15;
+      std::uint64_t z = seed;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+      word = z ^ (z >> 31);
+    }
+  }
+
+  static constexpr result_type min() noexcept
+  {
+    return 0;
+  }
+
+  static constexpr result_type max() noexcept
+  {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()() noexcept
+  {
+    std::uint64_t const result = rotl(state[0] + state[3], 23) + state[0];
+    std::uint64_t const t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+    return result;
+  }
+
+  /**
+   * @brief uniform in [0, bound) for 0 < bound: the high 32 bits of a draw scaled by
+   * bound (Lemire), no division, a bias below bound / 2^32
+   */
+  Index below(Index bound) noexcept
+  {
+    return static_cast<Index>(((*this)() >> 32) * static_cast<std::uint64_t>(bound) >>
+                              32);
+  }
+
+  /**
+   * @brief uniform in [0, 1) with the 53 bits of a double
+   */
+  double unit() noexcept
+  {
+    return static_cast<double>((*this)() >> 11) * 0x1.0p-53;
+  }
+};
+
+/**
+ * @brief the generator of the calling thread, seeded once per thread: the threads draw
+ * independent streams without synchronization
+ */
+inline Xoshiro256pp& thread_random_generator()
+{
+  static thread_local Xoshiro256pp gen(
+    static_cast<std::uint64_t>(std::random_device{}()) << 32 | std::random_device{}());
+  return gen;
+}
+
+} // namespace fai
@@ -1,7 +1,13 @@
 #include "Task.hpp"
+#include "dynasearch.hpp"
 #include "heuristics.hpp"
 #include "iterated_local_search.hpp"
 #include "local_search.hpp"
+#include "precedence.hpp"
+#include "search_stats.hpp"
+#include "simulated_annealing.hpp"
+#include "tabu_search.hpp"
+#include "thread_pool.hpp"
 #include "utils.hpp"
 
 #include <fmt/core.h>
@@ -10,6 +16,7 @@
 #include <boost/program_options.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <csignal>
 #include <filesystem>
 #include <fstream>
@@ -19,22 +26,30 @@
 #include <list>
 #include <locale>
 #include <numeric>
+#include <optional>
 #include <random>
 #include <stdexcept>
+#include <thread>
 
 namespace fs = std::filesystem;
 namespace po = boost::program_options;
 using namespace std::literals;
 
+/**
+ * @brief read a solution and check it is a valid scheduling
+ *
+ * @throw std::invalid_argument if the solution isn't a permutation of the tasks
+ */
 Scheduling read_solution(std::istream& in, fai::Index nb_tasks)
 {
   Scheduling sol;
   sol.reserve(nb_tasks);
   std::copy_n(std::istream_iterator<fai::Index>(in), nb_tasks, std::back_inserter(sol));
+  check_scheduling(nb_tasks, sol);
   return sol;
 }
 
-fai::vector<Task> read_tasks(std::istream& in)
+Task_table read_tasks(std::istream& in)
 {
   int nb_task;
   in >> nb_task;
@@ -45,7 +60,7 @@ fai::vector<Task> read_tasks(std::istream& in)
     in >> tasks.emplace_back();
     tasks.back().no = i;
   }
-  return tasks;
+  return Task_table(std::move(tasks));
 }
 
 Scheduling generate_random_solution(fai::Index nb_tasks)
@@ -56,13 +71,16 @@ Scheduling generate_random_solution(fai::Index nb_tasks)
   return sol;
 }
 
-void treat_solution(fai::vector<Task> const& tasks,
-                    Scheduling&&             sol,
-                    std::string const&       base_name,
-                    std::string const&       short_details,
-                    std::string_view         desc)
+void treat_solution(Task_table const&   tasks,
+                    Scored_scheduling&& scored_sol,
+                    std::string const&  base_name,
+                    std::string const&  short_details,
+                    std::string_view    desc)
 {
-  fai::Cost cost = evaluate(tasks, sol);
+  // the cost comes with the solution, only its validity is checked
+  check_scheduling(tasks.size(), scored_sol.solution);
+  Scheduling const& sol = scored_sol.solution;
+  fai::Cost         cost = scored_sol.cost;
   fmt::print("Total cost {}: {:L}\n", desc, cost);
 
   std::filesystem::create_directory("sols");
@@ -80,29 +98,226 @@ void treat_solution(fai::vector<Task> const& tasks,
   }
 }
 
+/**
+ * @brief how main runs the local searches
+ */
+struct Search_setup
+{
+  fai::Index              nb_scan_threads{1};
+  Precedence_table const* precedences{nullptr};
+  Search_stats*           stats{nullptr};
+
+  /**
+   * @brief options of the search name, the pool runs its scans
+   */
+  Search_options get_options(std::string name, Thread_pool& pool) const
+  {
+    return {&pool, precedences, &stats->add_search(std::move(name))};
+  }
+};
+
 template <typename Neighborhood, typename Select_fn>
-auto launch(fai::vector<Task> const& tasks,
-            Scheduling const&        sol,
+auto launch(Task_table const&        tasks,
+            Scored_scheduling const& sol,
             std::string const&       base_name,
-            Select_fn&&              select_fn)
+            Select_fn&&              select_fn,
+            Search_setup             setup)
+{
+  // select_fn may be a temporary of the caller, it is copied in the thread
+  return std::async(
+    std::launch::async,
+    [&tasks,
+     &sol,
+     &base_name,
+     select_fn = std::forward<Select_fn>(select_fn),
+     setup]() mutable
+    {
+      std::string short_name = fmt::format("hc_{}_{}",
+                                           select_fn_name(select_fn),
+                                           get_neighborhood_short_name<Neighborhood>());
+      Thread_pool pool(setup.nb_scan_threads);
+      auto        gen_sol = hill_climbing<Neighborhood>(tasks,
+                                                 sol,
+                                                 select_fn,
+                                                 setup.get_options(short_name, pool));
+      treat_solution(tasks,
+                     std::move(gen_sol),
+                     base_name,
+                     short_name,
+                     fmt::format("Hill climbing {} {}",
+                                 select_fn_name(select_fn),
+                                 get_neighborhood_name<Neighborhood>()));
+    });
+}
+
+template <typename... Neighborhoods, typename Select_fn>
+auto launch_vnd(Task_table const&        tasks,
+                Scored_scheduling const& sol,
+                std::string const&       base_name,
+                Select_fn&&              select_fn,
+                Search_setup             setup)
+{
+  return std::async(
+    std::launch::async,
+    [&, setup]()
+    {
+      std::string short_name = fmt::format("{}_{}",
+                                           get_vnd_short_name<Neighborhoods...>(),
+                                           select_fn_name(select_fn));
+      Thread_pool pool(setup.nb_scan_threads);
+      auto        gen_sol = vnd<Neighborhoods...>(tasks,
+                                           sol,
+                                           select_fn,
+                                           setup.get_options(short_name, pool));
+      treat_solution(tasks,
+                     std::move(gen_sol),
+                     base_name,
+                     short_name,
+                     fmt::format("{} {}",
+                                 get_vnd_name<Neighborhoods...>(),
+                                 select_fn_name(select_fn)));
+    });
+}
+
+auto launch_dynasearch(Task_table const&        tasks,
+                       Scored_scheduling const& sol,
+                       std::string const&       base_name,
+                       Search_setup             setup)
 {
   return std::async(std::launch::async,
-                    [&]()
+                    [&, setup]()
                     {
-                      auto gen_sol = hill_climbing<Neighborhood>(tasks, sol, select_fn);
-                      treat_solution(
-                        tasks,
-                        std::move(gen_sol),
-                        base_name,
-                        fmt::format("hc_{}_{}",
-                                    select_fn_name(select_fn),
-                                    get_neighborhood_short_name<Neighborhood>()),
-                        fmt::format("Hill climbing {} {}",
-                                    select_fn_name(select_fn),
-                                    get_neighborhood_name<Neighborhood>()));
+                      std::string short_name = "dyna";
+                      // dynasearch scans sequentially
+                      Thread_pool pool(1);
+                      auto        gen_sol =
+                        dynasearch(tasks, sol, setup.get_options(short_name, pool));
+                      treat_solution(tasks,
+                                     std::move(gen_sol),
+                                     base_name,
+                                     short_name,
+                                     "Dynasearch swaps and insertions");
                     });
 }
 
+template <typename Neighborhood, typename Select_fn>
+auto launch_tabu(Task_table const&        tasks,
+                 Scored_scheduling const& sol,
+                 std::string const&       base_name,
+                 Select_fn&&              select_fn,
+                 Tabu_params              params,
+                 Search_setup             setup)
+{
+  return std::async(
+    std::launch::async,
+    [&, params, setup]()
+    {
+      std::string short_name = fmt::format("tabu{}_{}_{}",
+                                           params.tenure,
+                                           select_fn_name(select_fn),
+                                           get_neighborhood_short_name<Neighborhood>());
+      // the tabu scans are sequential
+      Thread_pool    pool(1);
+      Search_options options = setup.get_options(short_name, pool);
+      // the worse neighbors can leave the local optima, even the adjacent interchanges
+      // breaking a proven order
+      options.precedences = nullptr;
+      auto gen_sol = tabu_search<Neighborhood>(tasks, sol, select_fn, params, options);
+      treat_solution(tasks,
+                     std::move(gen_sol),
+                     base_name,
+                     short_name,
+                     fmt::format("Tabu search tenure {} {} {}",
+                                 params.tenure,
+                                 select_fn_name(select_fn),
+                                 get_neighborhood_name<Neighborhood>()));
+    });
+}
+
+template <typename Neighborhood>
+auto launch_annealing(Task_table const&        tasks,
+                      Scored_scheduling const& sol,
+                      std::string const&       base_name,
+                      Annealing_params         params,
+                      Search_setup             setup)
+{
+  return std::async(
+    std::launch::async,
+    [&, params, setup]()
+    {
+      std::string short_name = fmt::format("sa_{}_{}",
+                                           get_cooling_name(params.cooling),
+                                           get_neighborhood_short_name<Neighborhood>());
+      Thread_pool pool(1);
+      auto        gen_sol = simulated_annealing<Neighborhood>(
+        tasks, sol, params, setup.get_options(short_name, pool));
+      treat_solution(tasks,
+                     std::move(gen_sol),
+                     base_name,
+                     short_name,
+                     fmt::format("Simulated annealing {} cooling {}",
+                                 get_cooling_name(params.cooling),
+                                 get_neighborhood_name<Neighborhood>()));
+    });
+}
+
+/**
+ * @brief one ILS per island, the islands alternate the reverses and the insertions as
+ * perturbations and their minimal number of random moves
+ *
+ * local_search_fn(tasks, base_solution, options)
+ */
+template <typename Local_search_fn>
+void run_island_ils(Task_table const&        tasks,
+                    Scored_scheduling const& sol,
+                    std::string const&       base_name,
+                    Local_search_fn const&   local_search_fn,
+                    std::string const&       ls_short_name,
+                    std::string const&       ls_name,
+                    fai::Index               nb_islands,
+                    long                     migration_interval,
+                    Search_setup             setup)
+{
+  fai::Index const min_distances[]{5, 10, 15, 20};
+
+  std::string short_name =
+    fmt::format("ils{}x{}_best_{}", nb_islands, migration_interval, ls_short_name);
+  auto gen_sol = island_ils(
+    static_cast<std::size_t>(nb_islands),
+    [&](std::size_t island, Migration_ring& ring)
+    {
+      Thread_pool    pool(setup.nb_scan_threads);
+      Search_options options =
+        setup.get_options(fmt::format("{}_island{}", short_name, island), pool);
+      fai::Index min_distance = min_distances[island / 2 % std::size(min_distances)];
+      auto       run = [&](auto&& perturbation)
+      {
+        return ils(
+          tasks,
+          sol,
+          [&](Task_table const& tasks, Scored_scheduling&& base_solution)
+          { return local_search_fn(tasks, std::move(base_solution), options); },
+          perturbation,
+          Migrating_accept(accept_best, ring, island, migration_interval),
+          stop_n_worse<20>);
+      };
+      if (island % 2 == 0)
+      {
+        return run(Adaptive_perturbation<Sliding_reverse_neighborhood<20>>(min_distance));
+      }
+      return run(Adaptive_perturbation<Bounded_insertion_neighborhood<20>>(min_distance));
+    });
+  treat_solution(tasks,
+                 std::move(gen_sol),
+                 base_name,
+                 short_name,
+                 fmt::format("ILS ({}) {} islands migrating every {} iterations "
+                             "accept_best stop_n_worse<20> perturb: adaptive srn20|in20",
+                             ls_name,
+                             nb_islands,
+                             migration_interval));
+}
+
 std::atomic<int> nb_ctrl_c = 0;
 extern "C" void  interrupt_handler(int)
 {
@@ -121,7 +336,18 @@ void help(std::string_view file_name)
              "{0} <problem_file> --heuristics\n"
              "{0} <problem_file> --random\n"
              "{0} <problem_file> --hc [--sol <solution_file>|--random]\n"
-             "{0} <problem_file> --ils [--sol <solution_file>|--random]\n",
+             "{0} <problem_file> --ils [--sol <solution_file>|--random]\n"
+             "{0} <problem_file> --vnd [--ils] [--sol <solution_file>|--random]\n"
+             "{0} <problem_file> --dynasearch [--ils] [--sol <solution_file>|--random]\n"
+             "{0} <problem_file> --tabu [--tabu-tenure <iterations>] [--time-limit "
+             "<seconds>]\n"
+             "{0} <problem_file> --sa [--sa-cooling geometric|adaptive] [--time-limit "
+             "<seconds>]\n"
+             "{0} <problem_file> --ils --islands <nb_islands> [--migration-interval "
+             "<iterations>]\n"
+             "{0} <problem_file> --hc|--ils --scan-threads <nb_threads>\n"
+             "{0} <problem_file> --hc|--ils --no-dominance\n"
+             "{0} <problem_file> --hc|--ils --stats-interval <ms> [--stats-json]\n",
              file_name);
 }
 
@@ -137,6 +363,13 @@ int main(int argc, char** argv)
 
   std::string problem_file_name;
   std::string sol_file_name;
+  fai::Index  nb_scan_threads = 1;
+  long        stats_interval_ms = 1000;
+  long        tabu_tenure = 0;
+  double      time_limit_s = 60;
+  fai::Index  nb_islands = 1;
+  long        migration_interval = 10;
+  std::string cooling_name = "adaptive";
 
   po::options_description desc("Options");
   desc.add_options()("help", "produce help message")                               //
@@ -145,6 +378,35 @@ int main(int argc, char** argv)
     ("random", "generate random scheduling")                                       //
     ("hc", "hill climbing")                                                        //
     ("ils", "Iterated local search")                                               //
+    ("vnd", "variable neighborhood descent, local search of the ILS with --ils")   //
+    ("dynasearch",
+     "dynasearch of the swaps and insertions, local search of the ILS with --ils") //
+    ("tabu", "tabu search on the swaps")                                           //
+    ("tabu-tenure",
+     po::value<long>(&tabu_tenure),
+     "iterations a task can't go back to a position it left, n by default") //
+    ("sa", "simulated annealing on the swaps of tasks at most 20 positions away") //
+    ("sa-cooling",
+     po::value<std::string>(&cooling_name),
+     "cooling of the simulated annealing: geometric or adaptive (default)") //
+    ("time-limit",
+     po::value<double>(&time_limit_s),
+     "seconds before the tabu search or the simulated annealing stops, 60 by default") //
+    ("no-dominance", "evaluate the moves breaking a proven task order")            //
+    ("stats-interval",
+     po::value<long>(&stats_interval_ms),
+     "milliseconds between 2 reports of the searches progress, 0 to disable") //
+    ("stats-json", "report the searches progress as json lines")             //
+    ("islands",
+     po::value<fai::Index>(&nb_islands)
+       ->implicit_value(static_cast<fai::Index>(std::thread::hardware_concurrency())),
+     "parallel ILS on a ring of islands, one per core without a value") //
+    ("migration-interval",
+     po::value<long>(&migration_interval),
+     "iterations between 2 exchanges of the islands best solutions, 10 by default") //
+    ("scan-threads",
+     po::value<fai::Index>(&nb_scan_threads),
+     "threads scanning the neighborhood of each local search") //
     ("problem_file",
      po::value<std::string>(&problem_file_name)->required(),
      "Problem file") //
@@ -180,7 +442,30 @@ int main(int argc, char** argv)
     fmt::print("Error opening file {}", problem_file_name);
     return 1;
   }
-  fai::vector<Task> const tasks = read_tasks(tasks_file);
+  Task_table const tasks = read_tasks(tasks_file);
+  fmt::print("Evaluation: {} kernel, {} batch kernel, {} bits arithmetic\n",
+             get_isa_name(get_evaluate_isa()),
+             get_isa_name(get_host_isa()),
+             tasks.is_narrow() ? 32 : 64);
+
+  // built once, the adjacent interchanges breaking these orders are skipped by the local
+  // searches
+  Precedence_table const dominance_orders(tasks);
+  fmt::print("Dominance rules: {} proven task orders\n", dominance_orders.count());
+
+  Search_stats stats;
+  Search_setup setup{nb_scan_threads,
+                     vm.count("no-dominance") ? nullptr : &dominance_orders,
+                     &stats};
+  // the searches only update their counters, the reporter does the printing
+  std::optional<Stats_reporter> reporter;
+  if (stats_interval_ms > 0)
+  {
+    reporter.emplace(stats,
+                     std::chrono::milliseconds(stats_interval_ms),
+                     vm.count("stats-json") ? Stats_reporter::Format::json
+                                            : Stats_reporter::Format::text);
+  }
 
   std::string_view best_algo = "undefined";
   Scheduling       best_sol;
@@ -194,9 +479,17 @@ int main(int argc, char** argv)
       fmt::print("Error opening file {}", sol_file_name);
       return 1;
     }
-    best_sol = read_solution(sol_file, tasks.size());
+    try
+    {
+      best_sol = read_solution(sol_file, tasks.size());
+    }
+    catch (std::invalid_argument const& e)
+    {
+      fmt::print("Invalid solution in {}: {}\n", sol_file_name, e.what());
+      return 1;
+    }
     best_algo = "user provided";
-    best_sol_cost = evaluate(tasks, best_sol);
+    best_sol_cost = evaluate_unchecked(tasks, best_sol);
     fmt::print("User provided Scheduling: {}\n", best_sol);
     fmt::print("{} Total cost: {:L}\n", best_algo, best_sol_cost);
   }
@@ -227,7 +520,7 @@ int main(int argc, char** argv)
 
   for (auto&& heuristic : get_heuristics())
   {
-    auto sol = ct_heuristic(tasks, select(heuristic.fn));
+    auto sol = ct_heuristic(tasks.get_tasks(), select(heuristic.fn));
     auto sol_cost = evaluate(tasks, sol);
     if (vm.count("heuristics"))
     {
@@ -242,36 +535,159 @@ int main(int argc, char** argv)
     }
   }
   fmt::print("\nBest algo: {} with cost: {:L}\n", best_algo, best_sol_cost);
+  Scored_scheduling const best_scored{std::move(best_sol), best_sol_cost};
 
   auto base_out_fname = fs::path(problem_file_name).stem().string();
   if (vm.count("ils"))
   {
-    using Local_search_nbh = Sliding_reverse_neighborhood<10>;
+    if (migration_interval <= 0)
+    {
+      fmt::print("The migration interval must be positive\n");
+      return 1;
+    }
     using Perturbation_nbh = Sliding_reverse_neighborhood<20>;
-    auto sol_ils = ils(
-      tasks,
-      best_sol,
-      [](fai::vector<Task> const& tasks, Scheduling&& base_solution) {
-        return hill_climbing<Local_search_nbh>(tasks,
-                                               std::move(base_solution),
-                                               select2best);
-      },
-      [](Scheduling& solution, std::vector<Scheduling>& history)
-      { return random_distant_neighbor<Perturbation_nbh>(solution, 15, history); },
-      accept_best,
-      stop_n_worse<20>);
-
-    treat_solution(
-      tasks,
-      std::move(sol_ils),
-      base_out_fname,
-      fmt::format("ils_best_hc_best_{}_pert_{}",
-                  get_neighborhood_short_name<Local_search_nbh>(),
-                  get_neighborhood_short_name<Perturbation_nbh>()),
-      fmt::format(
-        "ILS (HC select2best {}) accept_best stop_n_worse<20> perturb: rand<30>neigh {}",
-        get_neighborhood_name<Local_search_nbh>(),
-        get_neighborhood_name<Perturbation_nbh>()));
+    Thread_pool pool(nb_scan_threads);
+
+    // local_search_fn(tasks, base_solution, options)
+    auto run_ils = [&](auto&&             local_search_fn,
+                       std::string const& ls_short_name,
+                       std::string const& ls_name)
+    {
+      if (nb_islands > 1)
+      {
+        run_island_ils(tasks,
+                       best_scored,
+                       base_out_fname,
+                       local_search_fn,
+                       ls_short_name,
+                       ls_name,
+                       nb_islands,
+                       migration_interval,
+                       setup);
+        return;
+      }
+      std::string    short_name =
+        fmt::format("ils_best_{}_pert_adapt_{}",
+                    ls_short_name,
+                    get_neighborhood_short_name<Perturbation_nbh>());
+      Search_options options = setup.get_options(short_name, pool);
+      auto           sol_ils = ils(
+        tasks,
+        best_scored,
+        [&](Task_table const& tasks, Scored_scheduling&& base_solution)
+        { return local_search_fn(tasks, std::move(base_solution), options); },
+        Adaptive_perturbation<Perturbation_nbh>(),
+        accept_best,
+        stop_n_worse<20>);
+
+      treat_solution(
+        tasks,
+        std::move(sol_ils),
+        base_out_fname,
+        short_name,
+        fmt::format("ILS ({}) accept_best stop_n_worse<20> perturb: adaptive {}",
+                    ls_name,
+                    get_neighborhood_name<Perturbation_nbh>()));
+    };
+
+    if (vm.count("vnd"))
+    {
+      run_ils(
+        [](Task_table const&     tasks,
+           Scored_scheduling&&   base_solution,
+           Search_options const& options)
+        {
+          return vnd<Consecutive_single_swap_neighborhood,
+                     Sliding_reverse_neighborhood<10>,
+                     Reverse_neighborhood>(tasks,
+                                           std::move(base_solution),
+                                           select2best,
+                                           options);
+        },
+        fmt::format("{}_best",
+                    get_vnd_short_name<Consecutive_single_swap_neighborhood,
+                                       Sliding_reverse_neighborhood<10>,
+                                       Reverse_neighborhood>()),
+        fmt::format("{} select2best",
+                    get_vnd_name<Consecutive_single_swap_neighborhood,
+                                 Sliding_reverse_neighborhood<10>,
+                                 Reverse_neighborhood>()));
+    }
+    else if (vm.count("dynasearch"))
+    {
+      run_ils(
+        [](Task_table const&     tasks,
+           Scored_scheduling&&   base_solution,
+           Search_options const& options)
+        { return dynasearch(tasks, std::move(base_solution), options); },
+        "dyna",
+        "Dynasearch swaps and insertions");
+    }
+    else
+    {
+      using Local_search_nbh = Sliding_reverse_neighborhood<10>;
+      run_ils(
+        [](Task_table const&     tasks,
+           Scored_scheduling&&   base_solution,
+           Search_options const& options)
+        {
+          return hill_climbing<Local_search_nbh>(tasks,
+                                                 std::move(base_solution),
+                                                 select2best,
+                                                 options);
+        },
+        fmt::format("hc_best_{}", get_neighborhood_short_name<Local_search_nbh>()),
+        fmt::format("HC select2best {}", get_neighborhood_name<Local_search_nbh>()));
+    }
+  }
+  else if (vm.count("vnd"))
+  {
+    launch_vnd<Consecutive_single_swap_neighborhood,
+               Sliding_reverse_neighborhood<10>,
+               Reverse_neighborhood>(tasks,
+                                     best_scored,
+                                     base_out_fname,
+                                     select2first,
+                                     setup)
+      .wait();
+  }
+  else if (vm.count("dynasearch"))
+  {
+    launch_dynasearch(tasks, best_scored, base_out_fname, setup).wait();
+  }
+  else if (vm.count("sa"))
+  {
+    Annealing_params params;
+    if (cooling_name == "geometric")
+    {
+      params.cooling = Cooling::geometric;
+    }
+    else if (cooling_name != "adaptive")
+    {
+      fmt::print("Unknown cooling {}, use geometric or adaptive\n", cooling_name);
+      return 1;
+    }
+    params.time_limit = std::chrono::duration<double>(time_limit_s);
+    params.seed = std::random_device{}();
+    launch_annealing<Bounded_swap_neighborhood<20>>(tasks,
+                                                    best_scored,
+                                                    base_out_fname,
+                                                    params,
+                                                    setup)
+      .wait();
+  }
+  else if (vm.count("tabu"))
+  {
+    Tabu_params params;
+    params.tenure = tabu_tenure > 0 ? tabu_tenure : std::max(7L, long{tasks.size()});
+    params.time_limit = std::chrono::duration<double>(time_limit_s);
+    launch_tabu<Swap_neighborhood>(tasks,
+                                   best_scored,
+                                   base_out_fname,
+                                   select2best,
+                                   params,
+                                   setup)
+      .wait();
   }
 
   if (fai::stop_request())
@@ -284,32 +700,78 @@ int main(int argc, char** argv)
     std::vector<std::future<void>> compute_tasks;
     compute_tasks.push_back(
       launch<Backward_neighborhood<Consecutive_single_swap_neighborhood>>(tasks,
-                                                                          best_sol,
+                                                                          best_scored,
                                                                           base_out_fname,
-                                                                          select2first));
+                                                                          select2first,
+                                                                          setup));
     compute_tasks.push_back(launch<Consecutive_single_swap_neighborhood>(tasks,
-                                                                         best_sol,
+                                                                         best_scored,
                                                                          base_out_fname,
-                                                                         select2best));
+                                                                         select2best,
+                                                                         setup));
     compute_tasks.push_back(
       launch<Backward_neighborhood<Reverse_neighborhood>>(tasks,
-                                                          best_sol,
+                                                          best_scored,
                                                           base_out_fname,
-                                                          select2best_nfirst<5>{}));
+                                                          select2best_nfirst<5>{},
+                                                          setup));
     if (tasks.size() < 200)
     {
       compute_tasks.push_back(
-        launch<Reverse_neighborhood>(tasks, best_sol, base_out_fname, select2best));
+        launch<Reverse_neighborhood>(tasks,
+                                     best_scored,
+                                     base_out_fname,
+                                     select2best,
+                                     setup));
     }
     compute_tasks.push_back(
       launch<Backward_neighborhood<Sliding_reverse_neighborhood<10>>>(tasks,
-                                                                      best_sol,
+                                                                      best_scored,
                                                                       base_out_fname,
-                                                                      select2first));
+                                                                      select2first,
+                                                                      setup));
     compute_tasks.push_back(launch<Sliding_reverse_neighborhood<10>>(tasks,
-                                                                     best_sol,
+                                                                     best_scored,
                                                                      base_out_fname,
-                                                                     select2first));
+                                                                     select2first,
+                                                                     setup));
+    compute_tasks.push_back(launch<Insertion_neighborhood>(tasks,
+                                                           best_scored,
+                                                           base_out_fname,
+                                                           select2first,
+                                                           setup));
+    compute_tasks.push_back(launch<Insertion_neighborhood>(tasks,
+                                                           best_scored,
+                                                           base_out_fname,
+                                                           select2first_circular{},
+                                                           setup));
+    compute_tasks.push_back(launch<Bounded_insertion_neighborhood<10>>(tasks,
+                                                                       best_scored,
+                                                                       base_out_fname,
+                                                                       select2first,
+                                                                       setup));
+    compute_tasks.push_back(launch<Block_move_neighborhood<3>>(tasks,
+                                                               best_scored,
+                                                               base_out_fname,
+                                                               select2first,
+                                                               setup));
+    compute_tasks.push_back(
+      launch<Swap_neighborhood>(tasks,
+                                best_scored,
+                                base_out_fname,
+                                select2first,
+                                setup));
+    compute_tasks.push_back(
+      launch<Swap_neighborhood>(tasks,
+                                best_scored,
+                                base_out_fname,
+                                select2first_circular{},
+                                setup));
+    compute_tasks.push_back(launch<Bounded_swap_neighborhood<20>>(tasks,
+                                                                  best_scored,
+                                                                  base_out_fname,
+                                                                  select2first,
+                                                                  setup));
   }
   // sol = hill_climbing(tasks, best_sol, select2worst);
   // fmt::print("Total cost hill_climbing select2worst: {:L}\n", evaluate(tasks, sol));
@@ -0,0 +1,252 @@
+#pragma once
+
+#include "Task.hpp"
+#include "utils.hpp"
+
+#include <fmt/core.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief progress of a search, written by the thread running it only
+ *
+ * one cache line per search so that the concurrent searches don't invalidate each other
+ * counters, the writer doesn't need atomic read-modify-write instructions: the atomics
+ * are only there for the reporter to read them
+ */
+struct alignas(64) Search_counters
+{
+  // neighbors evaluated and skipped by the dominance rules
+  std::atomic<long> nb_neighbors{0};
+  std::atomic<long> nb_pruned{0};
+  // moves committed
+  std::atomic<long> nb_improvements{0};
+  // neighborhood scans
+  std::atomic<long>      nb_loops{0};
+  std::atomic<fai::Cost> best_cost{std::numeric_limits<fai::Cost>::max()};
+
+  static void add(std::atomic<long>& counter, long value) noexcept
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief a neighborhood scan, nb_evaluated neighbors evaluated and nb_skipped pruned
+   */
+  void add_scan(long nb_evaluated, long nb_skipped) noexcept
+  {
+    add(nb_loops, 1);
+    add(nb_neighbors, nb_evaluated);
+    add(nb_pruned, nb_skipped);
+  }
+
+  void add_improvement(fai::Cost cost) noexcept
+  {
+    add(nb_improvements, 1);
+    update_best(cost);
+  }
+
+  void update_best(fai::Cost cost) noexcept
+  {
+    if (cost < best_cost.load(std::memory_order_relaxed))
+    {
+      best_cost.store(cost, std::memory_order_relaxed);
+    }
+  }
+};
+
+/**
+ * @brief a sample of the counters of a search
+ */
+struct Search_sample
+{
+  std::string name;
+  long        nb_neighbors;
+  long        nb_pruned;
+  long        nb_improvements;
+  long        nb_loops;
+  fai::Cost   best_cost;
+};
+
+/**
+ * @brief the counters of the searches of the program
+ */
+class Search_stats
+{
+private:
+  struct Named_counters
+  {
+    std::string     name;
+    Search_counters counters;
+
+    explicit Named_counters(std::string name) : name(std::move(name)) {}
+  };
+
+  mutable std::mutex mutex;
+  // a deque doesn't move its elements, the counters given to the searches stay valid
+  std::deque<Named_counters> searches;
+
+public:
+  /**
+   * @brief new counters for the search name, valid as long as this
+   */
+  Search_counters& add_search(std::string name)
+  {
+    std::lock_guard lock(mutex);
+    return searches.emplace_back(std::move(name)).counters;
+  }
+
+  [[nodiscard]] std::vector<Search_sample> sample() const
+  {
+    std::lock_guard            lock(mutex);
+    std::vector<Search_sample> samples;
+    samples.reserve(searches.size());
+    for (Named_counters const& search : searches)
+    {
+      Search_counters const& counters = search.counters;
+      samples.push_back({search.name,
+                         counters.nb_neighbors.load(std::memory_order_relaxed),
+                         counters.nb_pruned.load(std::memory_order_relaxed),
+                         counters.nb_improvements.load(std::memory_order_relaxed),
+                         counters.nb_loops.load(std::memory_order_relaxed),
+                         counters.best_cost.load(std::memory_order_relaxed)});
+    }
+    return samples;
+  }
+};
+
+/**
+ * @brief prints the counters of stats every interval from a background thread
+ *
+ * the rates are computed between 2 samples, a last sample is printed when the reporter is
+ * destroyed
+ */
+class Stats_reporter
+{
+public:
+  enum class Format
+  {
+    text,
+    // one json object per sample and per line
+    json,
+  };
+
+private:
+  Search_stats const&       stats;
+  std::chrono::milliseconds interval;
+  Format                    format;
+  std::FILE*                out;
+
+  std::chrono::steady_clock::time_point start_time{std::chrono::steady_clock::now()};
+  std::chrono::steady_clock::time_point last_time{start_time};
+  std::vector<Search_sample>            last_samples;
+
+  std::mutex              mutex;
+  std::condition_variable stop_cv;
+  bool                    stopping{false};
+  std::thread             reporter;
+
+  void report()
+  {
+    auto                          now = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = now - start_time;
+    std::chrono::duration<double> sample_time = now - last_time;
+    double                        seconds = sample_time.count();
+    std::vector<Search_sample>    samples = stats.sample();
+
+    std::string line;
+    if (format == Format::json)
+    {
+      line = fmt::format(R"({{"time_s": {:.3f}, "searches": [)", elapsed.count());
+    }
+    for (std::size_t i = 0; i < samples.size(); ++i)
+    {
+      Search_sample const& sample = samples[i];
+      Search_sample const  last = i < last_samples.size()
+                                    ? last_samples[i]
+                                    : Search_sample{sample.name, 0, 0, 0, 0, 0};
+      double loops_per_s = static_cast<double>(sample.nb_loops - last.nb_loops) / seconds;
+      double neighbors_per_s =
+        static_cast<double>(sample.nb_neighbors - last.nb_neighbors) / seconds;
+      if (format == Format::json)
+      {
+        line += fmt::format(
+          R"({}{{"name": "{}", "best": {}, "loops": {}, "loops_per_s": {:.2f}, )"
+          R"("neighbors": {}, "neighbors_per_s": {:.0f}, "pruned": {}, )"
+          R"("improvements": {}}})",
+          i == 0 ? "" : ", ",
+          sample.name,
+          sample.best_cost,
+          sample.nb_loops,
+          loops_per_s,
+          sample.nb_neighbors,
+          neighbors_per_s,
+          sample.nb_pruned,
+          sample.nb_improvements);
+      }
+      else
+      {
+        line += fmt::format("[{:.1f}s] {}: best {:L}, {:.2f} loop/s, {:.0f} neighbors/s, "
+                            "{} improvements, {} pruned\n",
+                            elapsed.count(),
+                            sample.name,
+                            sample.best_cost,
+                            loops_per_s,
+                            neighbors_per_s,
+                            sample.nb_improvements,
+                            sample.nb_pruned);
+      }
+    }
+    if (format == Format::json)
+    {
+      line += "]}\n";
+    }
+    fmt::print(out, "{}", line);
+    std::fflush(out);
+
+    last_samples = std::move(samples);
+    last_time = now;
+  }
+
+public:
+  Stats_reporter(Search_stats const&       stats,
+                 std::chrono::milliseconds interval,
+                 Format                    format = Format::text,
+                 std::FILE*                out = stdout)
+    : stats(stats), interval(interval), format(format), out(out)
+  {
+    reporter = std::thread(
+      [this]
+      {
+        std::unique_lock lock(mutex);
+        while (!stop_cv.wait_for(lock, this->interval, [this] { return stopping; }))
+        {
+          report();
+        }
+      });
+  }
+
+  Stats_reporter(Stats_reporter const&) = delete;
+  Stats_reporter& operator=(Stats_reporter const&) = delete;
+
+  ~Stats_reporter()
+  {
+    {
+      std::lock_guard lock(mutex);
+      stopping = true;
+    }
+    stop_cv.notify_one();
+    reporter.join();
+    report();
+  }
+};
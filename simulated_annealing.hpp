@@ -0,0 +1,208 @@
+#pragma once
+
+#include "Task.hpp"
+#include "delta_evaluation.hpp"
+#include "local_search.hpp"
+#include "move.hpp"
+#include "random.hpp"
+#include "utils.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief how the temperature decreases between 2 epochs
+ */
+enum class Cooling
+{
+  // multiplied by cooling_rate
+  geometric,
+  // multiplied or divided by cooling_rate to follow a rate of accepted worse moves going
+  // from initial_acceptance to final_acceptance over the time limit
+  adaptive,
+};
+
+inline std::string_view get_cooling_name(Cooling cooling) noexcept
+{
+  switch (cooling)
+  {
+  case Cooling::geometric:
+    return "geometric";
+  case Cooling::adaptive:
+    return "adaptive";
+  }
+  return "";
+}
+
+struct Annealing_params
+{
+  Cooling cooling{Cooling::adaptive};
+  // probability to accept the average worse move at the start, gives the initial
+  // temperature
+  double initial_acceptance{0.3};
+  // rate of accepted worse moves at the end of the time limit for the adaptive cooling
+  double final_acceptance{1e-4};
+  double cooling_rate{0.98};
+  // moves drawn at each temperature
+  long epoch_length{100'000};
+  // epochs without a new best solution before the temperature goes back to
+  // reheat_ratio * the initial temperature, 0 to never reheat
+  long   reheat_epochs{200};
+  double reheat_ratio{0.5};
+  std::chrono::duration<double> time_limit{60};
+  std::uint64_t                 seed{0};
+};
+
+/**
+ * @brief simulated annealing on the moves of Neighborhood
+ *
+ * each step draws a move of Neighborhood with its random access get_move, evaluates it
+ * in O(block size) with an Incremental_evaluation and applies it by the Metropolis rule:
+ * a worse neighbor by delta is accepted with probability exp(-delta / temperature). The
+ * small neighborhoods (cssn, bounded swaps and insertions) give millions of steps per
+ * second.
+ *
+ * stops after params.time_limit or on a stop request
+ *
+ * @return the best solution met
+ */
+template <typename Neighborhood>
+Scored_scheduling simulated_annealing(Task_table const&       tasks,
+                                      Scored_scheduling       base_solution,
+                                      Annealing_params const& params,
+                                      Search_options const&   options = {})
+{
+  using Clock = std::chrono::steady_clock;
+  auto const start_time = Clock::now();
+
+  fai::Index const nb_tasks = base_solution.solution.size();
+  fai::Index const nb_moves = Neighborhood::get_size(nb_tasks);
+  if (nb_moves == 0)
+  {
+    return base_solution;
+  }
+  fai::Xoshiro256pp gen(params.seed);
+  auto draw_move = [&] { return Neighborhood::get_move(nb_tasks, gen.below(nb_moves)); };
+
+  Incremental_evaluation eval(tasks, std::move(base_solution.solution));
+  Scored_scheduling      best_solution{eval.get_solution(), eval.get_cost()};
+  // the best solution is only copied when the search leaves it for a worse neighbor
+  bool best_saved = true;
+  if (options.counters != nullptr)
+  {
+    options.counters->update_best(best_solution.cost);
+  }
+
+  // the average worse move is accepted with probability initial_acceptance
+  double total_worse_delta = 0;
+  long   nb_worse = 0;
+  for (long step = 0; step < 1000; ++step)
+  {
+    fai::Cost delta = eval.get_neighbor_cost(draw_move()) - eval.get_cost();
+    if (delta > 0)
+    {
+      total_worse_delta += static_cast<double>(delta);
+      ++nb_worse;
+    }
+  }
+  double const initial_temperature =
+    nb_worse == 0 ? 1.
+                  : -total_worse_delta / static_cast<double>(nb_worse) /
+                      std::log(params.initial_acceptance);
+  double temperature = initial_temperature;
+  long   nb_epochs_since_best = 0;
+
+  while (true)
+  {
+    long      nb_epoch_worse = 0;
+    long      nb_epoch_worse_accepted = 0;
+    fai::Cost epoch_best_cost = best_solution.cost;
+    for (long step = 0; step < params.epoch_length; ++step)
+    {
+      Move      move = draw_move();
+      fai::Cost neighbor_cost = eval.get_neighbor_cost(move);
+      fai::Cost delta = neighbor_cost - eval.get_cost();
+      if (delta > 0)
+      {
+        ++nb_epoch_worse;
+        if (gen.unit() >= std::exp(-static_cast<double>(delta) / temperature))
+        {
+          continue;
+        }
+        ++nb_epoch_worse_accepted;
+        if (!best_saved)
+        {
+          best_solution.solution = eval.get_solution();
+          best_saved = true;
+        }
+      }
+      eval.apply(move, neighbor_cost);
+      if (neighbor_cost < best_solution.cost)
+      {
+        best_solution.cost = neighbor_cost;
+        best_saved = false;
+      }
+    }
+
+    if (options.counters != nullptr)
+    {
+      options.counters->add_scan(params.epoch_length, 0);
+      if (best_solution.cost < epoch_best_cost)
+      {
+        options.counters->add_improvement(best_solution.cost);
+      }
+    }
+
+    std::chrono::duration<double> elapsed = Clock::now() - start_time;
+    if (fai::stop_request() || elapsed >= params.time_limit)
+    {
+      break;
+    }
+
+    nb_epochs_since_best =
+      best_solution.cost < epoch_best_cost ? 0 : nb_epochs_since_best + 1;
+    if (params.reheat_epochs > 0 && nb_epochs_since_best >= params.reheat_epochs)
+    {
+      temperature = params.reheat_ratio * initial_temperature;
+      nb_epochs_since_best = 0;
+      continue;
+    }
+    switch (params.cooling)
+    {
+    case Cooling::geometric:
+      temperature *= params.cooling_rate;
+      break;
+    case Cooling::adaptive:
+    {
+      double progress = std::min(elapsed / params.time_limit, 1.);
+      double target_acceptance =
+        params.initial_acceptance *
+        std::pow(params.final_acceptance / params.initial_acceptance, progress);
+      double acceptance = nb_epoch_worse == 0
+                            ? 0.
+                            : static_cast<double>(nb_epoch_worse_accepted) /
+                                static_cast<double>(nb_epoch_worse);
+      temperature = acceptance > target_acceptance ? temperature * params.cooling_rate
+                                                   : temperature / params.cooling_rate;
+      break;
+    }
+    }
+  }
+
+  if (!best_saved)
+  {
+    best_solution.solution = eval.get_solution();
+  }
+  if (fai::stop_request())
+  {
+    fmt::print("\nStopped at {} with:\n  {}\n",
+               best_solution.cost,
+               best_solution.solution);
+  }
+  return best_solution;
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include "Task.hpp"
+#include "delta_evaluation.hpp"
+#include "local_search.hpp"
+#include "move.hpp"
+#include "neighborhood.hpp"
+#include "precedence.hpp"
+#include "utils.hpp"
+
+#include <fmt/core.h>
+
+#include <array>
+#include <chrono>
+#include <limits>
+#include <optional>
+#include <vector>
+
+/**
+ * @brief a task leaving a position or arriving at one
+ */
+struct Task_position
+{
+  fai::Index task;
+  fai::Index position;
+};
+
+/**
+ * @brief the 2 tasks at the ends of the block of a move, at the positions they reach
+ *
+ * the swaps and the reverses exchange them, the rotations move the first task of each
+ * block: these tasks describe the move for the tabu memory
+ */
+inline std::array<Task_position, 2> get_moved_tasks(Scheduling const& solution,
+                                                    Move const&       move) noexcept
+{
+  switch (move.type)
+  {
+  case Move::Type::swap:
+  case Move::Type::reverse:
+    return {{{solution[move.beg], move.end - 1}, {solution[move.end - 1], move.beg}}};
+  case Move::Type::rotate:
+    return {{{solution[move.middle], move.beg},
+             {solution[move.beg], move.beg + move.end - move.middle}}};
+  }
+  return {};
+}
+
+/**
+ * @brief forbids the tasks to come back to the positions they recently left
+ *
+ * one expiry iteration per (task, position) attribute, directly indexed: O(1) to
+ * check or to record a move, n^2 iterations stored
+ */
+class Tabu_memory
+{
+private:
+  fai::Index nb_tasks;
+  // tabu_until[task * nb_tasks + position]: first iteration where task can go back to
+  // position
+  std::vector<long> tabu_until;
+
+  [[nodiscard]] std::size_t get_index(Task_position attribute) const noexcept
+  {
+    return static_cast<std::size_t>(attribute.task) * static_cast<std::size_t>(nb_tasks) +
+           static_cast<std::size_t>(attribute.position);
+  }
+
+public:
+  explicit Tabu_memory(fai::Index nb_tasks)
+    : nb_tasks(nb_tasks),
+      tabu_until(static_cast<std::size_t>(nb_tasks) * static_cast<std::size_t>(nb_tasks))
+  {
+  }
+
+  /**
+   * @brief true if move brings a task back to a position it left before iteration
+   */
+  [[nodiscard]] bool is_tabu(Scheduling const& solution,
+                             Move const&       move,
+                             long              iteration) const noexcept
+  {
+    for (Task_position moved : get_moved_tasks(solution, move))
+    {
+      if (tabu_until[get_index(moved)] > iteration)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief forbids the tasks moved by move to go back to their positions in solution
+   * until iteration + tenure, solution is the one before the move
+   */
+  void add(Scheduling const& solution, Move const& move, long iteration, long tenure)
+  {
+    for (Task_position moved : get_moved_tasks(solution, move))
+    {
+      // the position the task leaves
+      fai::Index position = move.beg + move.end - 1 - moved.position;
+      if (move.type == Move::Type::rotate)
+      {
+        position = moved.position == move.beg ? move.middle : move.beg;
+      }
+      tabu_until[get_index({moved.task, position})] = iteration + tenure;
+    }
+  }
+};
+
+/**
+ * @brief when the tabu search stops
+ */
+struct Tabu_params
+{
+  // iterations a task can't go back to a position it left
+  long tenure{10};
+  long max_iterations{std::numeric_limits<long>::max()};
+  std::chrono::duration<double> time_limit{std::chrono::duration<double>::max()};
+};
+
+/**
+ * @brief select the move of neigh_op leading to the neighbor chosen by select among the
+ * non tabu ones, worse neighbors included
+ *
+ * a tabu move is still admissible when its neighbor is better than best_cost (aspiration)
+ *
+ * the moves keeping the cost are skipped: the tasks in time can be permuted without
+ * changing it, the search would wander on that plateau
+ *
+ * @return the selected move, none if every move is tabu or pruned
+ */
+template <typename Neigh_op, typename Select2_fn>
+std::optional<Scored_move> next_tabu_neighbor(Task_table const&     tasks,
+                                              Neigh_op&             neigh_op,
+                                              Select2_fn&&          select,
+                                              Tabu_memory const&    tabu,
+                                              long                  iteration,
+                                              fai::Cost             best_cost,
+                                              Search_options const& options = {})
+{
+  Scheduling const& base_sol = neigh_op.get_base_solution();
+  Prefix_evaluation base_eval(tasks, base_sol);
+  fai::Cost         base_cost = base_eval.get_cost();
+  std::optional<Precedence_filter> filter;
+  if (options.precedences != nullptr)
+  {
+    filter.emplace(*options.precedences, base_sol);
+  }
+
+  std::optional<Scored_move> selected_neigh;
+  long                       nb_neigh = 0;
+  long                       nb_pruned = 0;
+  fai::Index                 nb_imp_neigh = 0;
+  for (auto it = begin_moves(neigh_op); it != std::end(neigh_op); ++it)
+  {
+    if (filter && filter->breaks(*it))
+    {
+      ++nb_pruned;
+      continue;
+    }
+    ++nb_neigh;
+    fai::Cost curr_cost = it.get_cost(base_eval);
+    if (curr_cost == base_cost ||
+        (curr_cost >= best_cost && tabu.is_tabu(base_sol, *it, iteration)))
+    {
+      continue;
+    }
+    Scored_move neigh_move{*it, curr_cost};
+    if (!selected_neigh)
+    {
+      selected_neigh = neigh_move;
+    }
+    else
+    {
+      if (select(tasks, *selected_neigh, neigh_move, nb_imp_neigh).brk)
+      {
+        break;
+      }
+      ++nb_imp_neigh;
+    }
+  }
+  if (options.counters != nullptr)
+  {
+    options.counters->add_scan(nb_neigh, nb_pruned);
+  }
+  return selected_neigh;
+}
+
+/**
+ * @brief tabu search on Neighborhood: moves to the neighbor chosen by select among the
+ * non tabu ones even when it is worse, the moved tasks can't go back to the positions
+ * they left for params.tenure iterations
+ *
+ * stops after params.max_iterations moves, params.time_limit, when every move is tabu or
+ * on a stop request
+ *
+ * @return the best solution met
+ */
+template <typename Neighborhood, typename Select2_fn>
+Scored_scheduling tabu_search(Task_table const&     tasks,
+                              Scored_scheduling     base_solution,
+                              Select2_fn&&          select,
+                              Tabu_params const&    params,
+                              Search_options const& options = {})
+{
+  auto const start_time = std::chrono::steady_clock::now();
+  if (options.counters != nullptr)
+  {
+    options.counters->update_best(base_solution.cost);
+  }
+  Scored_scheduling best_solution = base_solution;
+  Tabu_memory       tabu(base_solution.solution.size());
+  for (long iteration = 0; iteration < params.max_iterations; ++iteration)
+  {
+    Neighborhood               nbh(std::move(base_solution.solution));
+    std::optional<Scored_move> selected_neigh = next_tabu_neighbor(
+      tasks, nbh, select, tabu, iteration, best_solution.cost, options);
+    base_solution.solution = std::move(nbh.get_base_solution());
+    if (!selected_neigh)
+    {
+      break;
+    }
+
+    tabu.add(base_solution.solution, selected_neigh->move, iteration, params.tenure);
+    apply_move(base_solution.solution, selected_neigh->move);
+    base_solution.cost = selected_neigh->cost;
+    if (base_solution.cost < best_solution.cost)
+    {
+      best_solution = base_solution;
+      if (options.counters != nullptr)
+      {
+        options.counters->add_improvement(best_solution.cost);
+      }
+    }
+
+    if (fai::stop_request())
+    {
+      fmt::print("\nStopped at {} with:\n  {}\n",
+                 best_solution.cost,
+                 best_solution.solution);
+      break;
+    }
+    if (std::chrono::steady_clock::now() - start_time >= params.time_limit)
+    {
+      break;
+    }
+  }
+  return best_solution;
+}
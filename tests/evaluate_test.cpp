@@ -0,0 +1,216 @@
+#include "../Task.hpp"
+#include "../utils.hpp"
+
+#include <fmt/core.h>
+#include <fmt/ranges.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+
+long failed_test = 0;
+
+bool assert_equal_fn(bool             expr,
+                     std::string_view msg,
+                     std::string_view expr_str,
+                     std::size_t      line,
+                     std::string_view file)
+{
+  if (!expr)
+  {
+    ++failed_test;
+    fmt::print(stderr,
+               "{}:{}: \033[31massert error\033[0m({}), {}\n",
+               file,
+               line,
+               expr_str,
+               msg);
+  }
+  return expr;
+}
+
+#define assert_equal(expr, msg) assert_equal_fn((expr), (msg), #expr, __LINE__, __FILE__)
+
+/**
+ * @brief random tasks, expiry_range controls the proportion of late tasks
+ */
+fai::vector<Task> generate_tasks(fai::Index    nb_tasks,
+                                 int           max_exec_time,
+                                 int           max_weight,
+                                 int           expiry_range,
+                                 std::mt19937& gen)
+{
+  std::uniform_int_distribution<> exec_dist(0, max_exec_time);
+  std::uniform_int_distribution<> weight_dist(1, max_weight);
+  std::uniform_int_distribution<> expiry_dist(0, expiry_range);
+
+  fai::vector<Task> tasks(nb_tasks);
+  for (fai::Index i = 0; i < nb_tasks; ++i)
+  {
+    tasks[i] = Task{i, exec_dist(gen), weight_dist(gen), expiry_dist(gen)};
+  }
+  return tasks;
+}
+
+/**
+ * @brief reference for Task_table::is_narrow: worst cost of the tasks in any scheduling
+ */
+bool fits_int32(fai::vector<Task> const& tasks)
+{
+  fai::Sched_time total_time = 0;
+  for (Task const& task : tasks)
+  {
+    total_time += task.exec_time;
+  }
+  fai::Cost max_cost = 0;
+  for (Task const& task : tasks)
+  {
+    max_cost += task.get_cost(total_time - task.exec_time);
+  }
+  return total_time <= std::numeric_limits<std::int32_t>::max() &&
+         max_cost <= std::numeric_limits<std::int32_t>::max();
+}
+
+void test_kernels(fai::vector<Task> const& tasks, std::mt19937& gen)
+{
+  Task_table const table(tasks);
+  Scheduling       sol(tasks.size());
+  std::iota(std::begin(sol), std::end(sol), 0);
+  std::shuffle(std::begin(sol), std::end(sol), gen);
+
+  fai::Cost expected = evaluate(tasks, sol);
+  assert_equal(table.is_narrow() == fits_int32(tasks),
+               fmt::format("{} bits arithmetic for {} tasks",
+                           table.is_narrow() ? 32 : 64,
+                           tasks.size()));
+  for (Isa isa : {Isa::scalar, Isa::avx2, Isa::avx512})
+  {
+    if (isa > get_host_isa())
+    {
+      continue;
+    }
+    fai::Cost cost = evaluate_unchecked(table, sol, isa);
+    assert_equal(cost == expected,
+                 fmt::format("{} kernel with {} tasks: {} != {}",
+                             get_isa_name(isa),
+                             tasks.size(),
+                             cost,
+                             expected));
+  }
+}
+
+void test_batch_kernels(fai::vector<Task> const& tasks,
+                        fai::Index               nb_candidates,
+                        std::mt19937&            gen)
+{
+  Task_table const        table(tasks);
+  std::vector<Scheduling> candidates;
+  fai::vector<fai::Cost>  expected;
+  for (fai::Index c = 0; c < nb_candidates; ++c)
+  {
+    Scheduling sol(tasks.size());
+    std::iota(std::begin(sol), std::end(sol), 0);
+    std::shuffle(std::begin(sol), std::end(sol), gen);
+    expected.push_back(evaluate(tasks, sol));
+    candidates.push_back(std::move(sol));
+  }
+
+  for (Isa isa : {Isa::scalar, Isa::avx2, Isa::avx512})
+  {
+    if (isa > get_host_isa())
+    {
+      continue;
+    }
+    assert_equal(evaluate_batch_unchecked(table, candidates, isa) == expected,
+                 fmt::format("{} batch kernel with {} candidates of {} tasks",
+                             get_isa_name(isa),
+                             nb_candidates,
+                             tasks.size()));
+  }
+}
+
+/**
+ * @brief check_scheduling and evaluate must reject the solutions which aren't
+ * permutations of the tasks
+ */
+void test_check_scheduling(std::mt19937& gen)
+{
+  fai::vector<Task> const tasks = generate_tasks(5, 100, 10, 25, gen);
+
+  auto throws = [&tasks](Scheduling const& solution)
+  {
+    bool check_throws = false;
+    bool evaluate_throws = false;
+    try
+    {
+      check_scheduling(tasks.size(), solution);
+    }
+    catch (std::invalid_argument const&)
+    {
+      check_throws = true;
+    }
+    try
+    {
+      evaluate(tasks, solution);
+    }
+    catch (std::invalid_argument const&)
+    {
+      evaluate_throws = true;
+    }
+    assert_equal(check_throws == evaluate_throws,
+                 fmt::format("check_scheduling and evaluate disagree on {}", solution));
+    return check_throws;
+  };
+
+  assert_equal(!throws({4, 2, 0, 1, 3}), "valid scheduling rejected");
+  assert_equal(throws({4, 2, 0, 1}), "missing task accepted");
+  assert_equal(throws({4, 2, 0, 1, 3, 0}), "extra task accepted");
+  assert_equal(throws({4, 2, 0, 1, 5}), "task after the last one accepted");
+  assert_equal(throws({4, 2, 0, -1, 3}), "negative task accepted");
+  assert_equal(throws({4, 2, 0, 2, 3}), "task scheduled twice accepted");
+}
+
+int main()
+{
+  fmt::print("host isa: {}\n", get_isa_name(get_host_isa()));
+
+  std::mt19937 gen(42);
+  // sizes around the vector widths to test the scalar tails
+  for (fai::Index nb_tasks : {0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 100, 1000})
+  {
+    for (int expiry_range : {0, 5 * nb_tasks, 50 * nb_tasks})
+    {
+      test_kernels(generate_tasks(nb_tasks, 100, 10, expiry_range, gen), gen);
+    }
+  }
+  // big costs, to check the 64 bits multiplications
+  test_kernels(generate_tasks(1000, 1'000'000'000, 1'000'000, 0, gen), gen);
+  // costs around the int32 limit
+  for (int max_weight : {40, 50, 60, 80, 200})
+  {
+    test_kernels(generate_tasks(1000, 100, max_weight, 0, gen), gen);
+  }
+
+  // candidates counts around the lanes counts to test the leftovers
+  for (fai::Index nb_candidates : {0, 1, 3, 4, 5, 8, 9, 17})
+  {
+    test_batch_kernels(generate_tasks(100, 100, 10, 500, gen), nb_candidates, gen);
+  }
+  test_batch_kernels(generate_tasks(1000, 1'000'000'000, 1'000'000, 0, gen), 16, gen);
+
+  test_check_scheduling(gen);
+
+  if (failed_test != 0)
+  {
+    fmt::print(stderr, "{} \033[31;1mtests failed\033[0m\n", failed_test);
+    return 1;
+  }
+  else
+  {
+    fmt::print(stderr, "\033[32;1mAll tests passed\033[0m\n");
+  }
+}
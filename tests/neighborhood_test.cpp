@@ -1,5 +1,13 @@
 #include "../Task.hpp"
+#include "../dynasearch.hpp"
+#include "../iterated_local_search.hpp"
+#include "../local_search.hpp"
 #include "../neighborhood.hpp"
+#include "../precedence.hpp"
+#include "../random.hpp"
+#include "../simulated_annealing.hpp"
+#include "../tabu_search.hpp"
+#include "../thread_pool.hpp"
 #include "../utils.hpp"
 
 #include <boost/range/adaptors.hpp>
@@ -9,9 +17,13 @@
 #include <fmt/ranges.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <numeric>
 #include <random>
 #include <string_view>
+#include <thread>
 #include <typeinfo>
 
 namespace bst = boost;
@@ -70,6 +82,12 @@ void print_rng_diffs(R1&& r1, R2&& r2)
   fmt::print("}}");
 }
 
+Scheduling get_neighbor(Scheduling neighbor, Move const& move)
+{
+  apply_move(neighbor, move);
+  return neighbor;
+}
+
 template <typename Neighborhood, typename Rng>
 void test_neighborhood(Scheduling const& base_sol, Rng const& rng_expected)
 {
@@ -79,9 +97,10 @@ void test_neighborhood(Scheduling const& base_sol, Rng const& rng_expected)
   long nb = 0;
   auto expect_it = std::begin(rng_expected);
   auto expect_end = std::end(rng_expected);
-  for (auto&& neigh : nbh)
+  for (Move move : nbh)
   {
     assert_equal(expect_it != expect_end, "reached end to soon");
+    Scheduling neigh = get_neighbor(base_sol, move);
     print_rng_diffs(base_sol, neigh);
     fmt::print("\n");
     assert_equal(
@@ -95,6 +114,15 @@ void test_neighborhood(Scheduling const& base_sol, Rng const& rng_expected)
   fmt::print("size: {}\n", nbh.size());
   fmt::print("nb: {}\n\n", nb);
   assert_equal(nbh.size() == nb, "size isn't correctly computed");
+
+  static_assert(has_static_iterator_v<Neighborhood>);
+  auto dyn_it = std::begin(nbh);
+  for (auto it = nbh.static_begin(); it != std::end(nbh); ++it, ++dyn_it)
+  {
+    assert_equal(dyn_it != std::end(nbh) && *it == *dyn_it,
+                 "static and polymorphic iterators moves differ");
+  }
+  assert_equal(dyn_it == std::end(nbh), "static iterator reached end to soon");
 }
 
 template <typename Neighborhood, typename Rng>
@@ -106,12 +134,13 @@ void random_access_neighbor_test(Scheduling const& base_sol, Rng const& rng_expe
   {
     auto rand_pick = nbhtest.begin();
     rand_pick += random_neigh_idx;
+    Scheduling neigh = get_neighbor(base_sol, *rand_pick);
     fmt::print("random access test for {}\n", get_neighborhood_name<Neighborhood>());
     assert_equal(
-      *rand_pick == rng_expected[random_neigh_idx],
+      neigh == rng_expected[random_neigh_idx],
       fmt::format("neighbor isn't generated correctly at pos {}", random_neigh_idx));
     fmt::print("  | received ");
-    print_rng_diffs(base_sol, *rand_pick);
+    print_rng_diffs(base_sol, neigh);
     fmt::print("\n  | expected ");
     print_rng_diffs(base_sol, rng_expected[random_neigh_idx]);
     fmt::print("\n");
@@ -127,6 +156,604 @@ void random_access_neighbor_test(Scheduling const& base_sol, Rng const& rng_expe
   check(ntest.size() - 1, ntest);
 }
 
+Task_table generate_tasks(fai::Index nb_tasks, int max_weight = 10)
+{
+  std::mt19937                    gen(42);
+  std::uniform_int_distribution<> exec_dist(1, 10);
+  std::uniform_int_distribution<> weight_dist(1, max_weight);
+  std::uniform_int_distribution<> expiry_dist(0, 5 * nb_tasks);
+
+  fai::vector<Task> tasks(nb_tasks);
+  for (fai::Index i = 0; i < nb_tasks; ++i)
+  {
+    tasks[i] = Task{i, exec_dist(gen), weight_dist(gen), expiry_dist(gen)};
+  }
+  return Task_table(std::move(tasks));
+}
+
+/**
+ * @brief at, index_of and iterator jumps must agree with the traversal
+ */
+template <typename Neighborhood>
+void test_move_indices(fai::Index nb_tasks)
+{
+  Scheduling base_sol(nb_tasks);
+  std::iota(std::begin(base_sol), std::end(base_sol), 0);
+  Neighborhood nbh{base_sol};
+  fmt::print("move indices test for {} with {} tasks\n",
+             get_neighborhood_name<Neighborhood>(),
+             nb_tasks);
+
+  fai::Index idx = 0;
+  for (auto it = nbh.static_begin(); it != std::end(nbh); ++it, ++idx)
+  {
+    Move move = *it;
+    assert_equal(nbh.at(idx) == move, fmt::format("at({}) != {}", idx, move));
+    assert_equal(nbh.index_of(move) == idx, fmt::format("index_of({}) != {}", move, idx));
+    assert_equal(*(nbh.static_begin() += idx) == move,
+                 fmt::format("static jump to {} != {}", idx, move));
+    auto back_it = std::begin(nbh);
+    back_it += nbh.size() - 1;
+    back_it += idx - nbh.size() + 1;
+    assert_equal(*back_it == move, fmt::format("jump back to {} != {}", idx, move));
+  }
+  assert_equal(idx == nbh.size(), "size isn't correctly computed");
+}
+
+template <typename Neighborhood>
+void test_neighborhood_cost(Task_table const& tasks, Scheduling const& base_sol)
+{
+  Neighborhood      nbh{base_sol};
+  Prefix_evaluation base_eval(tasks, base_sol);
+  fmt::print("cost test for {}\n", get_neighborhood_name<Neighborhood>());
+
+  assert_equal(base_eval.get_cost() == evaluate(tasks, base_sol),
+               "base solution cost isn't computed correctly");
+  fai::Index nb = 0;
+  for (auto it = std::begin(nbh); it != std::end(nbh); ++it)
+  {
+    assert_equal(it.get_cost(base_eval) == evaluate(tasks, get_neighbor(base_sol, *it)),
+                 fmt::format("neighbor {} cost isn't computed correctly", nb));
+    ++nb;
+  }
+}
+
+/**
+ * @brief swapping 2 tasks scheduled against a proven order never increases the cost
+ */
+void test_precedence_rules(Task_table const& tasks, Scheduling const& base_sol)
+{
+  Precedence_table precedences(tasks);
+  fmt::print("precedence rules test: {} orders\n", precedences.count());
+  assert_equal(precedences.count() > 0, "no proven order on the test instance");
+
+  fai::Cost base_cost = evaluate(tasks, base_sol);
+  for (fai::Index first = 0; first < base_sol.size(); ++first)
+  {
+    for (fai::Index second = first + 1; second < base_sol.size(); ++second)
+    {
+      if (precedences.precedes(base_sol[second], base_sol[first]))
+      {
+        assert_equal(
+          evaluate(tasks, get_neighbor(base_sol, Move::swap(first, second))) <= base_cost,
+          fmt::format("restoring the order of {} and {} increased the cost",
+                      base_sol[second],
+                      base_sol[first]));
+      }
+    }
+  }
+}
+
+/**
+ * @brief the filter must skip the adjacent interchanges inverting a proven order and
+ * only moves that don't improve the solution
+ */
+template <typename Neighborhood>
+void test_precedence_filter(Task_table const& tasks, Scheduling const& base_sol)
+{
+  Precedence_table precedences(tasks);
+  fmt::print("precedence filter test for {}\n", get_neighborhood_name<Neighborhood>());
+
+  Scheduling sol = base_sol;
+  std::mt19937 gen{42};
+  for (int shuffle = 0; shuffle < 20; ++shuffle)
+  {
+    std::shuffle(std::begin(sol), std::end(sol), gen);
+    Precedence_filter filter(precedences, sol);
+    fai::Cost         base_cost = evaluate(tasks, sol);
+    Neighborhood      nbh{sol};
+    for (Move move : nbh)
+    {
+      bool adjacent_inversion = move.end - move.beg == 2 &&
+                                precedences.precedes(sol[move.beg], sol[move.end - 1]);
+      assert_equal(filter.breaks(move) == adjacent_inversion,
+                   fmt::format("{} breaks a proven order: {}", move, adjacent_inversion));
+      if (filter.breaks(move))
+      {
+        fai::Cost neighbor_cost = evaluate(tasks, get_neighbor(sol, move));
+        assert_equal(neighbor_cost >= base_cost,
+                     fmt::format("{} skipped but improves {} to {}",
+                                 move,
+                                 base_cost,
+                                 neighbor_cost));
+      }
+    }
+  }
+}
+
+/**
+ * @brief the parallel scan must select the same moves as the sequential one
+ */
+template <typename Neighborhood>
+void test_parallel_scan(Task_table const& tasks,
+                        Scheduling const& base_sol,
+                        Thread_pool&      pool)
+{
+  Neighborhood nbh{base_sol};
+  fmt::print("parallel scan test for {}\n", get_neighborhood_name<Neighborhood>());
+
+  auto check = [&](auto&& select, std::string_view select_name, fai::Index start = 0)
+  {
+    std::optional<Scored_move> expected = next_neighbor_from(tasks, nbh, select, start);
+    std::optional<Scored_move> selected =
+      parallel_next_neighbor(tasks, nbh, select, pool, {}, start);
+    assert_equal(selected.has_value() == expected.has_value() &&
+                   (!expected ||
+                    (selected->move == expected->move && selected->cost == expected->cost)),
+                 fmt::format("parallel {} from {} selected another move",
+                             select_name,
+                             start));
+  };
+  check(select2best, "select2best");
+  check(select2first, "select2first");
+  check(select2first, "select2first", nbh.size() / 2);
+  check(select2first, "select2first", nbh.size() - 1);
+
+  // the neighbors are counted at the same point in both scans: on one thread, the chunks
+  // after the one where select2first breaks are cancelled like the rest of the sequential
+  // scan
+  Thread_pool     single_thread(1);
+  Search_counters sequential_counters;
+  Search_counters parallel_counters;
+  next_neighbor(tasks, nbh, select2first, {nullptr, nullptr, &sequential_counters});
+  parallel_next_neighbor(tasks,
+                         nbh,
+                         select2first,
+                         single_thread,
+                         {nullptr, nullptr, &parallel_counters});
+  assert_equal(sequential_counters.nb_neighbors == parallel_counters.nb_neighbors,
+               fmt::format("{} neighbors counted sequentially, {} in parallel",
+                           sequential_counters.nb_neighbors.load(),
+                           parallel_counters.nb_neighbors.load()));
+
+  // a single weighted task, scheduled second: only the moves scheduling it first improve,
+  // just one for the swaps and reversals. The chunk finding it cancels the others
+  fai::vector<Task> unit_tasks(base_sol.size());
+  for (fai::Index i = 0; i < unit_tasks.size(); ++i)
+  {
+    unit_tasks[i] = Task{static_cast<int>(i), 1, i == base_sol[1] ? 1 : 0, 0};
+  }
+  Task_table const one_imp_tasks(std::move(unit_tasks));
+  fai::Cost        base_cost = evaluate(one_imp_tasks, base_sol);
+  fai::Index       imp_move_no = 0;
+  for (; imp_move_no < nbh.size(); ++imp_move_no)
+  {
+    Scheduling neigh = base_sol;
+    apply_move(neigh, nbh.at(imp_move_no));
+    if (evaluate(one_imp_tasks, neigh) < base_cost)
+    {
+      break;
+    }
+  }
+  Search_counters            one_imp_counters;
+  std::optional<Scored_move> selected =
+    parallel_next_neighbor(one_imp_tasks,
+                           nbh,
+                           select2first,
+                           single_thread,
+                           {nullptr, nullptr, &one_imp_counters},
+                           imp_move_no);
+  assert_equal(selected && one_imp_counters.nb_neighbors < nbh.size(),
+               fmt::format("{} of {} neighbors counted after the improving move",
+                           one_imp_counters.nb_neighbors.load(),
+                           nbh.size()));
+}
+
+/**
+ * @brief a scan from start must select the first better neighbor after it, wrapping
+ * around, and the circular hill climbing must end in a local optimum
+ */
+template <typename Neighborhood>
+void test_circular_scan(Task_table const& tasks, Scheduling const& base_sol)
+{
+  Neighborhood nbh{base_sol};
+  fmt::print("circular scan test for {}\n", get_neighborhood_name<Neighborhood>());
+
+  fai::Cost  base_cost = evaluate(tasks, base_sol);
+  fai::Index nb_moves = nbh.size();
+  for (fai::Index start : {fai::Index{0}, nb_moves / 3, nb_moves - 1})
+  {
+    std::optional<Move> expected;
+    for (fai::Index idx = 0; idx < nb_moves && !expected; ++idx)
+    {
+      Move       move = nbh.at((start + idx) % nb_moves);
+      Scheduling neigh = base_sol;
+      apply_move(neigh, move);
+      if (evaluate(tasks, neigh) < base_cost)
+      {
+        expected = move;
+      }
+    }
+    std::optional<Scored_move> selected =
+      next_neighbor_from(tasks, nbh, select2first, start);
+    assert_equal(selected.has_value() == expected.has_value() &&
+                   (!expected || selected->move == *expected),
+                 fmt::format("scan from {} selected another move", start));
+  }
+
+  Scored_scheduling sol = hill_climbing<Neighborhood>(tasks,
+                                                      {base_sol, base_cost},
+                                                      select2first_circular{});
+  assert_equal(sol.cost == evaluate(tasks, sol.solution),
+               "circular hill climbing cost isn't up to date");
+  Neighborhood optimum_nbh{sol.solution};
+  assert_equal(!next_neighbor(tasks, optimum_nbh, select2first),
+               "circular hill climbing result isn't a local optimum");
+}
+
+/**
+ * @brief the vnd result must be a local optimum of each of its neighborhoods
+ */
+void test_vnd(Task_table const& tasks, Scheduling const& base_sol)
+{
+  fmt::print("vnd test\n");
+  Scored_scheduling sol =
+    vnd<Consecutive_single_swap_neighborhood,
+        Sliding_reverse_neighborhood<10>,
+        Reverse_neighborhood>(tasks, {base_sol, evaluate(tasks, base_sol)}, select2first);
+  assert_equal(sol.cost == evaluate(tasks, sol.solution), "vnd cost isn't up to date");
+  assert_equal(sol.cost < evaluate(tasks, base_sol), "vnd didn't improve the solution");
+
+  auto is_local_optimum = [&](auto nbh)
+  { return !next_neighbor(tasks, nbh, select2first).has_value(); };
+  assert_equal(
+    is_local_optimum(Consecutive_single_swap_neighborhood(sol.solution)) &&
+      is_local_optimum(Sliding_reverse_neighborhood<10>(sol.solution)) &&
+      is_local_optimum(Reverse_neighborhood(sol.solution)),
+    "vnd result isn't a local optimum of its neighborhoods");
+}
+
+/**
+ * @brief the dynasearch moves must give the cost they announce, gain at least as much as
+ * the best swap or insertion, and end in a local optimum of both neighborhoods
+ */
+void test_dynasearch(Task_table const& tasks, Scheduling const& base_sol)
+{
+  fmt::print("dynasearch test\n");
+  Prefix_evaluation    base_eval(tasks, base_sol);
+  Dynasearch_selection selection;
+  std::vector<Move>    moves;
+  fai::Cost            gain = selection.select(base_eval, nullptr, moves);
+  Scheduling           neigh = base_sol;
+  for (Move const& move : moves)
+  {
+    apply_move(neigh, move);
+  }
+  assert_equal(gain > 0 && evaluate(tasks, neigh) == base_eval.get_cost() - gain,
+               fmt::format("dynasearch moves {} don't gain {}", moves, gain));
+  assert_equal(moves.size() > 1, "dynasearch selected a single move");
+
+  Swap_neighborhood      swap_nbh{base_sol};
+  Insertion_neighborhood insertion_nbh{base_sol};
+  for (auto best_move : {next_neighbor(tasks, swap_nbh, select2best),
+                         next_neighbor(tasks, insertion_nbh, select2best)})
+  {
+    assert_equal(best_move && base_eval.get_cost() - best_move->cost <= gain,
+                 "dynasearch gains less than the best single move");
+  }
+
+  Scored_scheduling sol = dynasearch(tasks, {base_sol, base_eval.get_cost()});
+  assert_equal(sol.cost == evaluate(tasks, sol.solution),
+               "dynasearch cost isn't up to date");
+  Swap_neighborhood      optimum_swap_nbh{sol.solution};
+  Insertion_neighborhood optimum_insertion_nbh{sol.solution};
+  assert_equal(!next_neighbor(tasks, optimum_swap_nbh, select2first) &&
+                 !next_neighbor(tasks, optimum_insertion_nbh, select2first),
+               "dynasearch result isn't a local optimum of the swaps and insertions");
+}
+
+/**
+ * @brief a move must be tabu for tenure iterations when it brings back a task to the
+ * position it left
+ */
+void test_tabu_memory()
+{
+  fmt::print("tabu memory test\n");
+  Scheduling  sol{0, 1, 2, 3, 4, 5};
+  Tabu_memory tabu(sol.size());
+  Move const  insertion = Move::insertion(1, 4);
+  tabu.add(sol, insertion, 0, 3);
+  apply_move(sol, insertion);
+  // task 1 is at 4, task 2 at 1
+  assert_equal(tabu.is_tabu(sol, Move::insertion(4, 1), 2) &&
+                 tabu.is_tabu(sol, Move::swap(1, 4), 1) &&
+                 tabu.is_tabu(sol, Move::swap(1, 2), 2),
+               "moves bringing back the tasks to their positions aren't tabu");
+  assert_equal(!tabu.is_tabu(sol, Move::insertion(4, 1), 3) &&
+                 !tabu.is_tabu(sol, Move::swap(3, 5), 0),
+               "moves are tabu after their tenure or without returning tasks");
+}
+
+/**
+ * @brief the tabu search must go further than the descent on the same neighborhood
+ */
+void test_tabu_search(Task_table const& tasks, Scheduling const& base_sol)
+{
+  fmt::print("tabu search test\n");
+  Scored_scheduling const base{base_sol, evaluate(tasks, base_sol)};
+  Scored_scheduling descent = hill_climbing<Swap_neighborhood>(tasks, base, select2best);
+
+  Tabu_params params;
+  params.tenure = 10;
+  params.max_iterations = 300;
+  Scored_scheduling sol =
+    tabu_search<Swap_neighborhood>(tasks, base, select2best, params);
+  assert_equal(sol.cost == evaluate(tasks, sol.solution),
+               "tabu search cost isn't up to date");
+  assert_equal(sol.cost < descent.cost,
+               fmt::format("tabu search {} doesn't improve the descent {}",
+                           sol.cost,
+                           descent.cost));
+}
+
+template <typename Neighborhood>
+void test_incremental_evaluation(Task_table const& tasks, Scheduling const& base_sol)
+{
+  fmt::print("incremental evaluation test {}\n", get_neighborhood_name<Neighborhood>());
+  fai::Index const nb_moves = Neighborhood::get_size(base_sol.size());
+  std::mt19937     gen{42};
+  std::uniform_int_distribution<fai::Index> move_distrib(0, nb_moves - 1);
+
+  Incremental_evaluation eval(tasks, base_sol);
+  Scheduling             sol = base_sol;
+  for (int step = 0; step < 1000; ++step)
+  {
+    Move      move = Neighborhood::get_move(base_sol.size(), move_distrib(gen));
+    fai::Cost neighbor_cost = eval.get_neighbor_cost(move);
+    Scheduling neighbor = sol;
+    apply_move(neighbor, move);
+    assert_equal(neighbor_cost == evaluate(tasks, neighbor),
+                 fmt::format("incremental cost {} of {} isn't the one of {}",
+                             neighbor_cost,
+                             move,
+                             neighbor));
+    // the even steps only evaluate the move
+    if (step % 2 == 1)
+    {
+      eval.apply(move, neighbor_cost);
+      sol = std::move(neighbor);
+      assert_equal(eval.get_solution() == sol && eval.get_cost() == evaluate(tasks, sol),
+                   fmt::format("applying {} doesn't give {}", move, sol));
+    }
+  }
+}
+
+void test_simulated_annealing(Task_table const& tasks, Scheduling const& base_sol)
+{
+  fmt::print("simulated annealing test\n");
+  Scored_scheduling const base{base_sol, evaluate(tasks, base_sol)};
+  for (Cooling cooling : {Cooling::geometric, Cooling::adaptive})
+  {
+    Annealing_params params;
+    params.cooling = cooling;
+    params.epoch_length = 1000;
+    params.time_limit = std::chrono::milliseconds(100);
+    Scored_scheduling sol =
+      simulated_annealing<Bounded_swap_neighborhood<10>>(tasks, base, params);
+    assert_equal(sol.cost == evaluate(tasks, sol.solution),
+                 "simulated annealing cost isn't up to date");
+    assert_equal(sol.cost < base.cost,
+                 fmt::format("simulated annealing {} {} doesn't improve {}",
+                             get_cooling_name(cooling),
+                             sol.cost,
+                             base.cost));
+  }
+}
+
+void test_ils_history()
+{
+  fmt::print("ils history test\n");
+  Task_table const        tasks{};
+  Ils_history             history(4, 3);
+  std::vector<fai::Cost> const costs{50, 40, 60, 40, 45, 30, 70, 30, 35};
+  for (std::size_t i = 0; i < costs.size(); ++i)
+  {
+    history.push({Scheduling{static_cast<fai::Index>(i)}, costs[i]});
+  }
+
+  assert_equal(history.size() == 9 && history.get_nb_recent() == 4,
+               fmt::format("{} solutions, {} recent costs",
+                           history.size(),
+                           history.get_nb_recent()));
+  for (long age = 0; age < history.get_nb_recent(); ++age)
+  {
+    fai::Cost expected = costs[costs.size() - 1 - static_cast<std::size_t>(age)];
+    assert_equal(history.get_recent_cost(age) == expected,
+                 fmt::format("recent cost {} is {}, not {}",
+                             age,
+                             history.get_recent_cost(age),
+                             expected));
+  }
+
+  // the oldest of the best solutions
+  assert_equal(history.get_best().cost == 30 && history.get_best().solution[0] == 5,
+               fmt::format("best solution {} with cost {}",
+                           history.get_best().solution,
+                           history.get_best().cost));
+  assert_equal(history.get_nb_since_best() == 3,
+               fmt::format("{} iterations since the best", history.get_nb_since_best()));
+  assert_equal(!stop_n_worse<4>(tasks, history) && stop_n_worse<3>(tasks, history),
+               "stop_n_worse doesn't count the iterations since the best");
+
+  std::vector<fai::Cost> elite_costs;
+  for (Scored_scheduling const& elite : history.get_elites())
+  {
+    elite_costs.push_back(elite.cost);
+  }
+  std::vector<fai::Cost> const expected_elite_costs{30, 35, 40};
+  assert_equal(elite_costs == expected_elite_costs,
+               fmt::format("elite costs {}", elite_costs));
+}
+
+void test_random_generator()
+{
+  fmt::print("random generator test\n");
+  fai::Xoshiro256pp gen(42);
+  fai::Xoshiro256pp same_gen(42);
+  fai::Xoshiro256pp other_gen(43);
+  bool              same_stream = true;
+  bool              other_stream = true;
+  for (int i = 0; i < 100; ++i)
+  {
+    std::uint64_t draw = gen();
+    same_stream = same_stream && draw == same_gen();
+    other_stream = other_stream && draw == other_gen();
+  }
+  assert_equal(same_stream && !other_stream, "the streams don't follow the seeds");
+
+  fai::Index const bound = 7;
+  int const        nb_draws = 70'000;
+  std::vector<int> counts(bound);
+  bool             in_unit = true;
+  for (int i = 0; i < nb_draws; ++i)
+  {
+    fai::Index value = gen.below(bound);
+    assert_equal(0 <= value && value < bound,
+                 fmt::format("{} drawn below {}", value, bound));
+    ++counts[static_cast<std::size_t>(value)];
+    double unit = gen.unit();
+    in_unit = in_unit && 0. <= unit && unit < 1.;
+  }
+  assert_equal(in_unit, "unit draws out of [0, 1)");
+  // 5 standard deviations around nb_draws / bound
+  assert_equal(std::all_of(std::begin(counts),
+                           std::end(counts),
+                           [&](int count) { return std::abs(count - 10'000) < 500; }),
+               fmt::format("draws below {} aren't uniform: {}", bound, counts));
+
+  Scheduling solution(100);
+  std::iota(std::begin(solution), std::end(solution), 0);
+  Scheduling const base_sol = solution;
+  random_distant_neighbor<Sliding_reverse_neighborhood<20>>(solution, 30, Ils_history{});
+  assert_equal(solution != base_sol &&
+                 std::is_permutation(std::begin(solution),
+                                     std::end(solution),
+                                     std::begin(base_sol)),
+               fmt::format("{} isn't a perturbation of {}", solution, base_sol));
+}
+
+void test_thread_cpu_clock()
+{
+  using namespace std::chrono_literals;
+  fmt::print("thread cpu clock test\n");
+  auto start = fai::Thread_cpu_clock::now();
+  std::this_thread::sleep_for(100ms);
+  auto slept = fai::Thread_cpu_clock::now() - start;
+  assert_equal(slept < 50ms,
+               fmt::format("{} us of CPU time while sleeping",
+                           std::chrono::duration_cast<std::chrono::microseconds>(slept)
+                             .count()));
+
+  // busy until the thread used 10 ms of CPU time, a few seconds at most
+  auto wall_start = std::chrono::steady_clock::now();
+  start = fai::Thread_cpu_clock::now();
+  while (fai::Thread_cpu_clock::now() - start < 10ms &&
+         std::chrono::steady_clock::now() - wall_start < 5s)
+  {
+  }
+  assert_equal(fai::Thread_cpu_clock::now() - start >= 10ms,
+               "the CPU time doesn't advance while the thread works");
+}
+
+void test_adaptive_perturbation(Scheduling const& base_sol)
+{
+  fmt::print("adaptive perturbation test\n");
+  Adaptive_perturbation<Consecutive_single_swap_neighborhood> perturbation(4, 8, 1.5);
+  Ils_history                                                 history;
+  history.push({base_sol, 100});
+
+  std::vector<fai::Index> distances;
+  for (fai::Cost cost : {90, 100, 100, 100, 100})
+  {
+    Scheduling sol = base_sol;
+    perturbation(sol, history);
+    assert_equal(std::is_permutation(std::begin(sol),
+                                     std::end(sol),
+                                     std::begin(base_sol)),
+                 fmt::format("{} isn't a permutation of {}", sol, base_sol));
+    distances.push_back(perturbation.get_distance());
+    history.push({base_sol, cost});
+  }
+  // the new best solution found with 4 moves keeps the distance, then it grows up to 8
+  std::vector<fai::Index> const expected_distances{4, 4, 6, 8, 8};
+  assert_equal(distances == expected_distances,
+               fmt::format("distances {} instead of {}", distances, expected_distances));
+  Scheduling sol = base_sol;
+  perturbation(sol, history);
+  assert_equal(perturbation.get_distance() == 8,
+               fmt::format("distance {} after a stagnation at the max distance",
+                           perturbation.get_distance()));
+}
+
+void test_island_ils(Task_table const& tasks, Scheduling const& base_sol)
+{
+  fmt::print("island ils test\n");
+  Migration_ring ring(3);
+  ring.send(0, {base_sol, 20});
+  ring.send(0, {base_sol, 10});
+  std::unique_ptr<Scored_scheduling> migrant = ring.receive(1);
+  assert_equal(migrant && migrant->cost == 10, "the last solution sent isn't received");
+  assert_equal(!ring.receive(1) && !ring.receive(0) && !ring.receive(2),
+               "a solution is received twice or by the wrong island");
+  ring.send(2, {base_sol, 30});
+  assert_equal(ring.receive(0) != nullptr, "the ring doesn't wrap around");
+
+  Scored_scheduling const base{base_sol, evaluate(tasks, base_sol)};
+  std::vector<fai::Cost>  island_costs(4);
+  Scored_scheduling       sol = island_ils(
+    island_costs.size(),
+    [&](std::size_t island, Migration_ring& ring)
+    {
+      Scored_scheduling island_sol = ils(
+        tasks,
+        base,
+        [](Task_table const& tasks, Scored_scheduling&& base_solution)
+        {
+          return hill_climbing<Swap_neighborhood>(tasks,
+                                                  std::move(base_solution),
+                                                  select2first);
+        },
+        [&](Scheduling& solution, Ils_history const& history)
+        {
+          random_distant_neighbor<Bounded_insertion_neighborhood<5>>(
+            solution,
+            static_cast<fai::Index>(island + 2),
+            history);
+        },
+        Migrating_accept(accept_best, ring, island, 2),
+        stop_n_worse<5>);
+      island_costs[island] = island_sol.cost;
+      return island_sol;
+    });
+  assert_equal(sol.cost == evaluate(tasks, sol.solution),
+               "island ILS cost isn't up to date");
+  assert_equal(sol.cost == *std::min_element(std::begin(island_costs),
+                                             std::end(island_costs)),
+               fmt::format("island ILS {} isn't the best of the islands {}",
+                           sol.cost,
+                           island_costs));
+}
+
 int main(int argc, char** argv)
 {
   Scheduling base_sol(10);
@@ -220,6 +847,70 @@ int main(int argc, char** argv)
         Backward_neighborhood<Sliding_reverse_neighborhood<6>>{base_sol}.size()) |
       adp::reversed);
 
+  Scheduling small_sol(5);
+  std::iota(std::begin(small_sol), std::end(small_sol), 0);
+  std::vector<Scheduling> const in_neighs{
+    {1, 0, 2, 3, 4}, {1, 2, 0, 3, 4}, {1, 2, 3, 0, 4}, {1, 2, 3, 4, 0},
+    {0, 2, 1, 3, 4}, {0, 2, 3, 1, 4}, {0, 2, 3, 4, 1}, {0, 1, 3, 2, 4},
+    {0, 1, 3, 4, 2}, {2, 0, 1, 3, 4}, {0, 1, 2, 4, 3}, {0, 3, 1, 2, 4},
+    {3, 0, 1, 2, 4}, {0, 1, 4, 2, 3}, {0, 4, 1, 2, 3}, {4, 0, 1, 2, 3}};
+  test_neighborhood<Insertion_neighborhood>(small_sol, in_neighs);
+  test_neighborhood<Backward_neighborhood<Insertion_neighborhood>>(small_sol,
+                                                                   in_neighs |
+                                                                     adp::reversed);
+  std::vector<Scheduling> const in2_neighs{{1, 0, 2, 3, 4},
+                                           {1, 2, 0, 3, 4},
+                                           {0, 2, 1, 3, 4},
+                                           {0, 2, 3, 1, 4},
+                                           {0, 1, 3, 2, 4},
+                                           {0, 1, 3, 4, 2},
+                                           {2, 0, 1, 3, 4},
+                                           {0, 1, 2, 4, 3},
+                                           {0, 3, 1, 2, 4},
+                                           {0, 1, 4, 2, 3}};
+  test_neighborhood<Bounded_insertion_neighborhood<2>>(small_sol, in2_neighs);
+  test_neighborhood<Backward_neighborhood<Bounded_insertion_neighborhood<2>>>(
+    small_sol,
+    in2_neighs | adp::reversed);
+
+  std::vector<Scheduling> const bmn2_neighs{
+    {1, 0, 2, 3, 4}, {1, 2, 0, 3, 4}, {1, 2, 3, 0, 4}, {1, 2, 3, 4, 0},
+    {0, 2, 1, 3, 4}, {0, 2, 3, 1, 4}, {0, 2, 3, 4, 1}, {0, 1, 3, 2, 4},
+    {0, 1, 3, 4, 2}, {0, 1, 2, 4, 3}, {3, 0, 1, 2, 4}, {0, 4, 1, 2, 3},
+    {4, 0, 1, 2, 3}, {2, 0, 1, 3, 4}, {2, 3, 0, 1, 4}, {2, 3, 4, 0, 1},
+    {0, 3, 1, 2, 4}, {0, 3, 4, 1, 2}, {0, 1, 4, 2, 3}, {3, 4, 0, 1, 2}};
+  test_neighborhood<Block_move_neighborhood<2>>(small_sol, bmn2_neighs);
+  test_neighborhood<Backward_neighborhood<Block_move_neighborhood<2>>>(
+    small_sol,
+    bmn2_neighs | adp::reversed);
+  // single task blocks are insertions
+  test_neighborhood<Block_move_neighborhood<1>>(small_sol, in_neighs);
+
+  std::vector<Scheduling> const sn_neighs{{1, 0, 2, 3, 4},
+                                          {2, 1, 0, 3, 4},
+                                          {3, 1, 2, 0, 4},
+                                          {4, 1, 2, 3, 0},
+                                          {0, 2, 1, 3, 4},
+                                          {0, 3, 2, 1, 4},
+                                          {0, 4, 2, 3, 1},
+                                          {0, 1, 3, 2, 4},
+                                          {0, 1, 4, 3, 2},
+                                          {0, 1, 2, 4, 3}};
+  test_neighborhood<Swap_neighborhood>(small_sol, sn_neighs);
+  test_neighborhood<Backward_neighborhood<Swap_neighborhood>>(small_sol,
+                                                              sn_neighs | adp::reversed);
+  std::vector<Scheduling> const sn2_neighs{{1, 0, 2, 3, 4},
+                                           {2, 1, 0, 3, 4},
+                                           {0, 2, 1, 3, 4},
+                                           {0, 3, 2, 1, 4},
+                                           {0, 1, 3, 2, 4},
+                                           {0, 1, 4, 3, 2},
+                                           {0, 1, 2, 4, 3}};
+  test_neighborhood<Bounded_swap_neighborhood<2>>(small_sol, sn2_neighs);
+  test_neighborhood<Backward_neighborhood<Bounded_swap_neighborhood<2>>>(
+    small_sol,
+    sn2_neighs | adp::reversed);
+
   random_access_neighbor_test<Reverse_neighborhood>(base_sol, rn_neighs);
   random_access_neighbor_test<Backward_neighborhood<Reverse_neighborhood>>(
     base_sol,
@@ -237,6 +928,110 @@ int main(int argc, char** argv)
     base_sol,
     srn_neighs | adp::reversed);
 
+  for (fai::Index nb_tasks : {0, 1, 2, 3, 7, 10, 31})
+  {
+    test_move_indices<Consecutive_single_swap_neighborhood>(nb_tasks);
+    test_move_indices<Backward_neighborhood<Consecutive_single_swap_neighborhood>>(
+      nb_tasks);
+    test_move_indices<Reverse_neighborhood>(nb_tasks);
+    test_move_indices<Backward_neighborhood<Reverse_neighborhood>>(nb_tasks);
+    test_move_indices<Sliding_reverse_neighborhood<5>>(nb_tasks);
+    test_move_indices<Backward_neighborhood<Sliding_reverse_neighborhood<5>>>(nb_tasks);
+    test_move_indices<Sliding_reverse_neighborhood<10>>(nb_tasks);
+    test_move_indices<Insertion_neighborhood>(nb_tasks);
+    test_move_indices<Backward_neighborhood<Insertion_neighborhood>>(nb_tasks);
+    test_move_indices<Bounded_insertion_neighborhood<2>>(nb_tasks);
+    test_move_indices<Bounded_insertion_neighborhood<5>>(nb_tasks);
+    test_move_indices<Backward_neighborhood<Bounded_insertion_neighborhood<5>>>(
+      nb_tasks);
+    test_move_indices<Block_move_neighborhood<1>>(nb_tasks);
+    test_move_indices<Block_move_neighborhood<3>>(nb_tasks);
+    test_move_indices<Backward_neighborhood<Block_move_neighborhood<3>>>(nb_tasks);
+    test_move_indices<Swap_neighborhood>(nb_tasks);
+    test_move_indices<Backward_neighborhood<Swap_neighborhood>>(nb_tasks);
+    test_move_indices<Bounded_swap_neighborhood<1>>(nb_tasks);
+    test_move_indices<Bounded_swap_neighborhood<5>>(nb_tasks);
+    test_move_indices<Backward_neighborhood<Bounded_swap_neighborhood<5>>>(nb_tasks);
+  }
+
+  Task_table const tasks = generate_tasks(base_sol.size());
+  Scheduling       shuffled_sol = base_sol;
+  std::shuffle(std::begin(shuffled_sol), std::end(shuffled_sol), std::mt19937{42});
+
+  test_neighborhood_cost<Consecutive_single_swap_neighborhood>(tasks, shuffled_sol);
+  test_neighborhood_cost<Backward_neighborhood<Consecutive_single_swap_neighborhood>>(
+    tasks,
+    shuffled_sol);
+  test_neighborhood_cost<Reverse_neighborhood>(tasks, shuffled_sol);
+  test_neighborhood_cost<Backward_neighborhood<Reverse_neighborhood>>(tasks,
+                                                                      shuffled_sol);
+  test_neighborhood_cost<Sliding_reverse_neighborhood<5>>(tasks, shuffled_sol);
+  test_neighborhood_cost<Backward_neighborhood<Sliding_reverse_neighborhood<5>>>(
+    tasks,
+    shuffled_sol);
+  test_neighborhood_cost<Insertion_neighborhood>(tasks, shuffled_sol);
+  test_neighborhood_cost<Backward_neighborhood<Insertion_neighborhood>>(tasks,
+                                                                        shuffled_sol);
+  test_neighborhood_cost<Bounded_insertion_neighborhood<3>>(tasks, shuffled_sol);
+  test_neighborhood_cost<Block_move_neighborhood<3>>(tasks, shuffled_sol);
+  test_neighborhood_cost<Backward_neighborhood<Block_move_neighborhood<3>>>(tasks,
+                                                                           shuffled_sol);
+  test_neighborhood_cost<Swap_neighborhood>(tasks, shuffled_sol);
+  test_neighborhood_cost<Bounded_swap_neighborhood<4>>(tasks, shuffled_sol);
+
+  // swaps over many late, in time and critical tasks
+  Task_table const more_tasks = generate_tasks(100);
+  Scheduling       more_sol(more_tasks.size());
+  std::iota(std::begin(more_sol), std::end(more_sol), 0);
+  std::shuffle(std::begin(more_sol), std::end(more_sol), std::mt19937{42});
+  test_neighborhood_cost<Swap_neighborhood>(more_tasks, more_sol);
+
+  test_vnd(more_tasks, more_sol);
+  test_dynasearch(more_tasks, more_sol);
+  test_tabu_memory();
+  test_ils_history();
+  test_island_ils(more_tasks, more_sol);
+  test_thread_cpu_clock();
+  test_adaptive_perturbation(more_sol);
+  test_random_generator();
+  test_tabu_search(more_tasks, more_sol);
+  test_incremental_evaluation<Consecutive_single_swap_neighborhood>(more_tasks, more_sol);
+  test_incremental_evaluation<Bounded_swap_neighborhood<20>>(more_tasks, more_sol);
+  test_incremental_evaluation<Bounded_insertion_neighborhood<10>>(more_tasks, more_sol);
+  test_incremental_evaluation<Reverse_neighborhood>(more_tasks, more_sol);
+  test_simulated_annealing(more_tasks, more_sol);
+
+  test_circular_scan<Consecutive_single_swap_neighborhood>(more_tasks, more_sol);
+  test_circular_scan<Reverse_neighborhood>(more_tasks, more_sol);
+  test_circular_scan<Backward_neighborhood<Insertion_neighborhood>>(more_tasks, more_sol);
+  test_circular_scan<Swap_neighborhood>(more_tasks, more_sol);
+
+  test_precedence_rules(more_tasks, more_sol);
+  test_precedence_filter<Consecutive_single_swap_neighborhood>(more_tasks, more_sol);
+  test_precedence_filter<Swap_neighborhood>(more_tasks, more_sol);
+  test_precedence_filter<Reverse_neighborhood>(more_tasks, more_sol);
+  test_precedence_filter<Insertion_neighborhood>(more_tasks, more_sol);
+  test_precedence_filter<Block_move_neighborhood<3>>(more_tasks, more_sol);
+
+  Thread_pool pool(4);
+  test_parallel_scan<Reverse_neighborhood>(more_tasks, more_sol, pool);
+  test_parallel_scan<Backward_neighborhood<Reverse_neighborhood>>(more_tasks,
+                                                                 more_sol,
+                                                                 pool);
+  test_parallel_scan<Insertion_neighborhood>(more_tasks, more_sol, pool);
+  test_parallel_scan<Swap_neighborhood>(more_tasks, more_sol, pool);
+  test_parallel_scan<Block_move_neighborhood<3>>(more_tasks, more_sol, pool);
+
+  // costs overflowing 32 bits: int64 delta evaluation
+  Task_table const wide_tasks = generate_tasks(base_sol.size(), 1'000'000'000);
+  assert_equal(!wide_tasks.is_narrow(), "tasks with big weights must use int64");
+  test_neighborhood_cost<Consecutive_single_swap_neighborhood>(wide_tasks, shuffled_sol);
+  test_neighborhood_cost<Reverse_neighborhood>(wide_tasks, shuffled_sol);
+  test_neighborhood_cost<Sliding_reverse_neighborhood<5>>(wide_tasks, shuffled_sol);
+  test_neighborhood_cost<Insertion_neighborhood>(wide_tasks, shuffled_sol);
+  test_neighborhood_cost<Block_move_neighborhood<3>>(wide_tasks, shuffled_sol);
+  test_neighborhood_cost<Swap_neighborhood>(wide_tasks, shuffled_sol);
+
   if (failed_test != 0)
   {
     fmt::print(stderr, "{} \033[31;1mtests failed\033[0m\n", failed_test);
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "utils.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief fixed set of threads running the same job together
+ *
+ * the threads are started once and wait for the next job, so a job can be as short as a
+ * neighborhood scan without paying a thread creation each time
+ */
+class Thread_pool
+{
+private:
+  std::vector<std::thread> workers;
+
+  std::mutex              mutex;
+  std::condition_variable job_cv;
+  std::condition_variable done_cv;
+
+  // current job, type erased without allocation: call(job_ctx, worker_no)
+  void const* job_ctx{nullptr};
+  void (*job_call)(void const*, fai::Index){nullptr};
+  // incremented for each job, a worker runs a job once
+  long       job_no{0};
+  fai::Index nb_running{0};
+  bool       stopping{false};
+
+  // serializes the jobs when the pool is shared
+  std::mutex run_mutex;
+
+  void work(fai::Index worker_no)
+  {
+    long last_job_no = 0;
+    while (true)
+    {
+      std::unique_lock lock(mutex);
+      job_cv.wait(lock, [&] { return stopping || job_no != last_job_no; });
+      if (stopping)
+      {
+        return;
+      }
+      last_job_no = job_no;
+      lock.unlock();
+
+      job_call(job_ctx, worker_no);
+
+      lock.lock();
+      if (--nb_running == 0)
+      {
+        done_cv.notify_one();
+      }
+    }
+  }
+
+public:
+  /**
+   * @param nb_threads number of threads running a job, the calling thread included
+   */
+  explicit Thread_pool(fai::Index nb_threads)
+  {
+    workers.reserve(static_cast<std::size_t>(std::max(nb_threads - 1, 0)));
+    for (fai::Index worker_no = 1; worker_no < nb_threads; ++worker_no)
+    {
+      workers.emplace_back([this, worker_no] { work(worker_no); });
+    }
+  }
+
+  Thread_pool(Thread_pool const&) = delete;
+  Thread_pool& operator=(Thread_pool const&) = delete;
+
+  ~Thread_pool()
+  {
+    {
+      std::lock_guard lock(mutex);
+      stopping = true;
+    }
+    job_cv.notify_all();
+    for (auto& worker : workers)
+    {
+      worker.join();
+    }
+  }
+
+  /**
+   * @brief number of threads running a job, the calling thread included
+   */
+  [[nodiscard]] fai::Index size() const noexcept
+  {
+    return fai::ssize(workers) + 1;
+  }
+
+  /**
+   * @brief call fn(worker_no) on each thread, worker_no in [0, size())
+   *
+   * the calling thread is the worker 0, returns once every call returned
+   */
+  template <typename Fn>
+  void run(Fn const& fn)
+  {
+    std::lock_guard run_lock(run_mutex);
+    {
+      std::lock_guard lock(mutex);
+      job_ctx = &fn;
+      job_call = [](void const* ctx, fai::Index worker_no)
+      { (*static_cast<Fn const*>(ctx))(worker_no); };
+      nb_running = fai::ssize(workers);
+      ++job_no;
+    }
+    job_cv.notify_all();
+
+    fn(fai::Index{0});
+
+    std::unique_lock lock(mutex);
+    done_cv.wait(lock, [&] { return nb_running == 0; });
+  }
+};
@@ -5,6 +5,8 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <ctime>
 #include <iostream>
 #include <memory>
 #include <vector>
@@ -105,6 +107,34 @@ public:
   }
 };
 
+/**
+ * @brief CPU time used by the calling thread, as a std::chrono clock
+ *
+ * unlike the wall time, it doesn't count the time the thread waits for a core when more
+ * threads than cores run. Process CPU time where the thread clock isn't available.
+ */
+struct Thread_cpu_clock
+{
+  using duration = std::chrono::nanoseconds;
+  using rep = duration::rep;
+  using period = duration::period;
+  using time_point = std::chrono::time_point<Thread_cpu_clock>;
+  static constexpr bool is_steady = true;
+
+  static time_point now() noexcept
+  {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return time_point(std::chrono::seconds(time.tv_sec) +
+                      std::chrono::nanoseconds(time.tv_nsec));
+#else
+    return time_point(std::chrono::duration_cast<duration>(
+      std::chrono::duration<double>(static_cast<double>(std::clock()) / CLOCKS_PER_SEC)));
+#endif
+  }
+};
+
 inline std::atomic<bool>& stop_request()
 {
   static std::atomic<bool> request = false;